@@ -7,3 +7,8 @@ REM font shader
 
 C:/VulkanSDK/1.3.250.0/Bin/glslc.exe font.vert -o font_vs.spv
 C:/VulkanSDK/1.3.250.0/Bin/glslc.exe font.frag -o font_fs.spv
+
+REM sprite shader
+
+C:/VulkanSDK/1.3.250.0/Bin/glslc.exe sprite.vert -o sprite_vs.spv
+C:/VulkanSDK/1.3.250.0/Bin/glslc.exe sprite.frag -o sprite_fs.spv
@@ -1,9 +1,12 @@
 #version 450
+#extension GL_EXT_nonuniform_qualifier : require // runtime sized descriptor arrays
 
-layout(binding = 1) uniform sampler2D tex_sampler[2];
+layout(set = 1, binding = 0) uniform texture2D textures[];
+layout(set = 1, binding = 1) uniform sampler samplers[2]; // immutable, SAMPLER_COUNT in samplers.hpp
 
 layout(push_constant) uniform Fragment_Constants {
-	layout(offset = 64) int texture_index;
+	layout(offset = 64) uint texture_index;
+	uint sampler_index;
 } pc;
 
 layout(location = 0) in vec2 frag_tex_coord;
@@ -12,5 +15,5 @@ layout(location = 0) out vec4 out_color;
 
 void main()
 {
-	out_color = texture(tex_sampler[pc.texture_index], frag_tex_coord);
+	out_color = texture(sampler2D(textures[pc.texture_index], samplers[pc.sampler_index]), frag_tex_coord);
 }
\ No newline at end of file
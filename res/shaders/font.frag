@@ -1,12 +1,25 @@
 #version 450
+#extension GL_EXT_nonuniform_qualifier : require // runtime sized descriptor arrays
 
-layout(binding = 1) uniform sampler2D tex_sampler;
+layout(set = 1, binding = 0) uniform texture2D textures[];
+layout(set = 1, binding = 1) uniform sampler samplers[2]; // immutable, SAMPLER_COUNT in samplers.hpp
+
+layout(push_constant) uniform Fragment_Constants {
+	layout(offset = 8) uint texture_index;
+	uint sampler_index;
+} pc;
 
 layout(location = 0) in vec2 frag_tex_coord;
+layout(location = 1) in vec4 frag_color;
 
 layout(location = 0) out vec4 out_color;
 
 void main()
 {
-	out_color = texture(tex_sampler, frag_tex_coord);
+	// the atlas holds signed distance fields, the glyph edge is at 128 / 255 (SDF_ON_EDGE in fonts.cpp).
+	// fwidth keeps the antialiased band about one pixel wide at any text size.
+	float distance = texture(sampler2D(textures[pc.texture_index], samplers[pc.sampler_index]), frag_tex_coord).r;
+	float edge_width = fwidth(distance);
+	float coverage = smoothstep(0.5 - edge_width, 0.5 + edge_width, distance);
+	out_color = vec4(frag_color.rgb, frag_color.a * coverage);
 }
\ No newline at end of file
@@ -1,20 +1,29 @@
 #version 450
 
-layout(binding = 0) uniform Uniform_Buffer_Object {
-	mat4 view;
-	mat4 proj;
-} ubo;
-
+// NOTE: one instance per glyph, the quad's corners come from the vertex index (6 vertices, two triangles)
 layout(push_constant) uniform Vertex_Constants {
-	mat4 model;
-	vec2 position;
-	vec2 tex_coord;
+	vec2 screen_size; // pixels
 } pc;
 
+layout(location = 0) in vec2 in_position; // top left, pixels
+layout(location = 1) in vec2 in_size;
+layout(location = 2) in vec2 in_uv_min;
+layout(location = 3) in vec2 in_uv_max;
+layout(location = 4) in vec4 in_color;
+
 layout(location = 0) out vec2 frag_tex_coord;
+layout(location = 1) out vec4 frag_color;
+
+const vec2 corners[6] = vec2[](
+	vec2(0.0, 0.0), vec2(1.0, 0.0), vec2(1.0, 1.0),
+	vec2(1.0, 1.0), vec2(0.0, 1.0), vec2(0.0, 0.0)
+);
 
 void main()
 {
-	gl_Position = ubo.proj * ubo.view * pc.model * vec4(pc.position, 0.0, 1.0);
-	frag_tex_coord = pc.tex_coord;
+	vec2 corner = corners[gl_VertexIndex];
+	vec2 position = in_position + corner * in_size;
+	gl_Position = vec4(position / pc.screen_size * 2.0 - 1.0, 0.0, 1.0);
+	frag_tex_coord = mix(in_uv_min, in_uv_max, corner);
+	frag_color = in_color;
 }
\ No newline at end of file
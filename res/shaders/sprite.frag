@@ -0,0 +1,23 @@
+#version 450
+#extension GL_EXT_nonuniform_qualifier : require // runtime sized descriptor arrays
+
+// NOTE: the same binding the other shaders see as texture2D, sprite families are registered with 2D array views
+layout(set = 1, binding = 0) uniform texture2DArray texture_arrays[];
+layout(set = 1, binding = 1) uniform sampler samplers[2]; // immutable, SAMPLER_COUNT in samplers.hpp
+
+layout(push_constant) uniform Fragment_Constants {
+	uint sampler_index;
+} pc;
+
+layout(location = 0) in vec2 frag_tex_coord;
+layout(location = 1) flat in uint frag_descriptor_index;
+layout(location = 2) flat in uint frag_layer;
+
+layout(location = 0) out vec4 out_color;
+
+void main()
+{
+	// the descriptor index comes from the instance, one draw mixes families
+	vec3 tex_coord = vec3(frag_tex_coord, float(frag_layer));
+	out_color = texture(sampler2DArray(texture_arrays[nonuniformEXT(frag_descriptor_index)], samplers[pc.sampler_index]), tex_coord);
+}
\ No newline at end of file
@@ -0,0 +1,33 @@
+#version 450
+
+layout(binding = 0) uniform Uniform_Buffer_Object {
+	mat4 view;
+	mat4 proj;
+} ubo;
+
+// NOTE: one instance per sprite, the quad's corners come from the vertex index (6 vertices, two triangles)
+layout(location = 0) in vec2 in_position; // center, world units
+layout(location = 1) in vec2 in_size;
+layout(location = 2) in vec2 in_uv_min;
+layout(location = 3) in vec2 in_uv_max;
+layout(location = 4) in uint in_descriptor_index;
+layout(location = 5) in uint in_layer;
+
+layout(location = 0) out vec2 frag_tex_coord;
+layout(location = 1) flat out uint frag_descriptor_index;
+layout(location = 2) flat out uint frag_layer;
+
+const vec2 corners[6] = vec2[](
+	vec2(0.0, 0.0), vec2(1.0, 0.0), vec2(1.0, 1.0),
+	vec2(1.0, 1.0), vec2(0.0, 1.0), vec2(0.0, 0.0)
+);
+
+void main()
+{
+	vec2 corner = corners[gl_VertexIndex];
+	vec2 position = in_position + (corner - 0.5) * in_size;
+	gl_Position = ubo.proj * ubo.view * vec4(position, 0.0, 1.0);
+	frag_tex_coord = mix(in_uv_min, in_uv_max, corner);
+	frag_descriptor_index = in_descriptor_index;
+	frag_layer = in_layer;
+}
\ No newline at end of file
@@ -1,32 +1,46 @@
 #include "assets.hpp"
 
+#include "platform.hpp"
+#include "mipmaps.hpp"
+#include "texture_compression.hpp"
 #include "renderer/vulkan_init.hpp"
 #include "renderer/vulkan_helper.hpp"
+#include "renderer/geometry.hpp"
+#include "renderer/upload.hpp"
+#include "renderer/bindless.hpp"
+#include "renderer/deletion_queue.hpp"
 
 #include <lib/stb_image.h>
 #include <vulkan/vulkan.h>
 
+#include <string.h>
+
+#include <string>
+#include <vector>
+
 //
 // Internal
 //
 
 typedef struct Tag_Texture_Asset_List {
 	uint count;
-	Texture textures[MAX_TEXTURE_BINDINGS];
-	Render_Buffer vertex_buffers[MAX_TEXTURE_BINDINGS];
-	Render_Buffer index_buffers[MAX_TEXTURE_BINDINGS];
+	std::vector<Texture> textures;
+	std::vector<Mesh> meshes;
+	std::vector<std::string> labels; // the file path the texture was loaded from
+	std::vector<Texture> sprite_families;
+	std::vector<std::string> sprite_family_labels; // the path of the family's first layer
 } Texture_Asset_List;
 
 Texture_Asset_List texture_asset_list = {};
 
-internal_function bool create_image(uint32 width, uint32 height, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage_flags, VkMemoryPropertyFlags property_flags, VkImage &image, VkDeviceMemory &image_memory) {
+internal_function bool create_image(uint32 width, uint32 height, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage_flags, VkMemoryPropertyFlags property_flags, VkImage &image, Memory_Allocation &image_memory, uint32 layer_count = 1, uint32 level_count = 1) {
 	VkImageCreateInfo image_info = {
 		.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
 		.imageType = VK_IMAGE_TYPE_2D,
 		.format = format,
 		.extent = { static_cast<uint32_t>(width), static_cast<uint32_t>(height), 1 },
-		.mipLevels = 1,
-		.arrayLayers = 1,
+		.mipLevels = level_count,
+		.arrayLayers = layer_count,
 		.samples = VK_SAMPLE_COUNT_1_BIT,
 		.tiling = tiling,
 		.usage = usage_flags,
@@ -40,126 +54,24 @@ internal_function bool create_image(uint32 width, uint32 height, VkFormat format
 	VkMemoryRequirements memory_requirements;
 	vkGetImageMemoryRequirements(c.device, image, &memory_requirements);
 
-	uint32_t index;
-	bool res = find_memory_type(memory_requirements.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &index);
+	bool res = allocate_memory(memory_requirements, property_flags, tiling == VK_IMAGE_TILING_OPTIMAL ? MEMORY_RESOURCE_OPTIMAL : MEMORY_RESOURCE_LINEAR, &image_memory);
 	if (!res) {
+		vkDestroyImage(c.device, image, 0);
 		return false;
 	}
-	VkMemoryAllocateInfo alloc_info = {
-		.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
-		.allocationSize = memory_requirements.size,
-		.memoryTypeIndex = index,
-	};
 
-	result = vkAllocateMemory(c.device, &alloc_info, 0, &image_memory);
-	if (result != VK_SUCCESS) {
-		return false;
-	}
-
-	vkBindImageMemory(c.device, image, image_memory, 0);
+	vkBindImageMemory(c.device, image, image_memory.memory, image_memory.offset);
 
 	return true;
 }
 
-internal_function bool transition_image_layout(VkImage image, VkFormat format, VkImageLayout old_layout, VkImageLayout new_layout) {
-	VkCommandBuffer command_buffer = begin_single_time_commands();
-
-	VkImageMemoryBarrier barrier = {
-		.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
-		.oldLayout = old_layout,
-		.newLayout = new_layout,
-		.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-		.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-		.image = image,
-		.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 },
-	};
-
-	VkPipelineStageFlags source_stage;
-	VkPipelineStageFlags destination_stage;
-	if (old_layout == VK_IMAGE_LAYOUT_UNDEFINED && new_layout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL) {
-		barrier.srcAccessMask = 0;
-		barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-
-		source_stage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
-		destination_stage = VK_PIPELINE_STAGE_TRANSFER_BIT;
-	}
-	else if (old_layout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL && new_layout == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL) {
-		barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-		barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-
-		source_stage = VK_PIPELINE_STAGE_TRANSFER_BIT;
-		destination_stage = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
-	}
-	else {
-		return false;
-	}
-
-	vkCmdPipelineBarrier(command_buffer, source_stage, destination_stage, 0, 0, 0, 0, 0, 1, &barrier);
-
-	end_single_time_commands(command_buffer);
-
-	return true;
-}
-
-internal_function bool copy_buffer_to_image(VkBuffer buffer, VkImage image, uint32 width, uint32 height) {
-	VkCommandBuffer command_buffer = begin_single_time_commands();
-
-	VkBufferImageCopy region = {
-		.bufferOffset = 0,
-		.bufferRowLength = 0,
-		.bufferImageHeight = 0,
-		.imageSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 },
-		.imageOffset = { 0, 0, 0 },
-		.imageExtent = { width, height, 1 },
-	};
-	vkCmdCopyBufferToImage(command_buffer, buffer, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
-
-	end_single_time_commands(command_buffer);
-
-	return true;
-}
-
-internal_function bool create_texture_image(const char *texture_data, int width, int height, int nr_channels, Texture *texture, VkFormat format = VK_FORMAT_R8G8B8A8_SRGB) {
-	if (!texture_data) return false;
-
-	VkDeviceSize image_size = width * height * nr_channels;
-
-	VkBuffer staging_buffer;
-	VkDeviceMemory staging_buffer_memory;
-
-	bool result = create_buffer(image_size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, staging_buffer, staging_buffer_memory);
-	if (!result) return false;
-
-	void *data;
-	vkMapMemory(c.device, staging_buffer_memory, 0, image_size, 0, &data);
-	memcpy(data, texture_data, static_cast<size_t>(image_size));
-	vkUnmapMemory(c.device, staging_buffer_memory);
-
-	result = create_image(width, height, format, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, texture->image, texture->memory);
-	if (!result) return false;
-
-	result = transition_image_layout(texture->image, format, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
-	if (!result) return false;
-
-	result = copy_buffer_to_image(staging_buffer, texture->image, static_cast<uint32_t>(width), static_cast<uint32_t>(height));
-	if (!result) return false;
-
-	result = transition_image_layout(texture->image, format, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
-	if (!result) return false;
-
-	vkDestroyBuffer(c.device, staging_buffer, 0);
-	vkFreeMemory(c.device, staging_buffer_memory, 0);
-
-	return true;
-}
-
-internal_function bool create_texture_image_view(Texture *texture, VkFormat format = VK_FORMAT_R8G8B8A8_SRGB) {
+internal_function bool create_texture_image_view(Texture *texture, VkFormat format = VK_FORMAT_R8G8B8A8_SRGB, VkImageViewType view_type = VK_IMAGE_VIEW_TYPE_2D, uint32 layer_count = 1, uint32 level_count = 1) {
 	VkImageViewCreateInfo view_info = {
 		.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
 		.image = texture->image,
-		.viewType = VK_IMAGE_VIEW_TYPE_2D,
+		.viewType = view_type,
 		.format = format,
-		.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 },
+		.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, level_count, 0, layer_count },
 	};
 	VkResult result = vkCreateImageView(c.device, &view_info, 0, &texture->image_view);
 	if (result != VK_SUCCESS) {
@@ -169,153 +81,140 @@ internal_function bool create_texture_image_view(Texture *texture, VkFormat form
 	return true;
 }
 
-internal_function bool create_texture_image_sampler(Texture *texture) {
-	VkSamplerCreateInfo sampler_info = {
-		.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO,
-		.magFilter = VK_FILTER_NEAREST,
-		.minFilter = VK_FILTER_NEAREST,
-		.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST,
-		.addressModeU = VK_SAMPLER_ADDRESS_MODE_REPEAT,
-		.addressModeV = VK_SAMPLER_ADDRESS_MODE_REPEAT,
-		.addressModeW = VK_SAMPLER_ADDRESS_MODE_REPEAT,
-		.mipLodBias = 0.0f,
-		.anisotropyEnable = VK_FALSE,
-		.compareEnable = VK_FALSE,
-		.compareOp = VK_COMPARE_OP_ALWAYS,
-		.minLod = 0.0f,
-		.maxLod = 0.0f,
-		.borderColor = VK_BORDER_COLOR_INT_OPAQUE_BLACK,
-		.unnormalizedCoordinates = VK_FALSE,
-	};
-	VkResult result = vkCreateSampler(c.device, &sampler_info, 0, &texture->sampler);
-	if (result != VK_SUCCESS) {
+// NOTE: textures whose texels we produce ourselves (decoders, mip chains) are written straight into the staging
+// memory between begin_texture and finish_texture, no heap buffer in between and no extra copy
+internal_function bool begin_texture(uint32 width, uint32 height, VkFormat format, uint32 layer_count, uint32 level_count, Texture *texture, Image_Upload *upload) {
+	bool result = create_image(width, height, format, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, texture->image, texture->memory, layer_count, level_count);
+	if (!result) return false;
+
+	result = upload_image_reserve(texture->image, format, width, height, layer_count, level_count, upload);
+	if (!result) {
+		defer_destroy_image(texture->image, texture->memory);
 		return false;
 	}
 
 	return true;
 }
 
-internal_function bool create_render_buffer(const void *elements, size_t size, Render_Buffer *render_buffer, Buffer_Type type) {
-	VkBufferUsageFlagBits usage_type;
-	switch (type) {
-		case VERTEX_BUFFER: {
-			usage_type = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT;
-			break;
-		}
-
-		case INDEX_BUFFER: {
-			usage_type = VK_BUFFER_USAGE_INDEX_BUFFER_BIT;
-			break;
-		}
-
-		default: {
-			return false;
-		}
-	}
-	render_buffer->type = type;
-
-	VkBuffer staging_buffer;
-	VkDeviceMemory staging_buffer_memory;
-
-	bool result = create_buffer(static_cast<uint64_t>(size), VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, staging_buffer, staging_buffer_memory);
+// the view covers every layer and level; on failure the image (and view) are gone, a copy into it may still be
+// in flight so they go through the deletion queue
+internal_function bool register_texture(Texture *texture, VkFormat format, VkImageViewType view_type, uint32 layer_count, uint32 level_count) {
+	bool result = create_texture_image_view(texture, format, view_type, layer_count, level_count);
 	if (!result) {
+		defer_destroy_image(texture->image, texture->memory);
 		return false;
 	}
 
-	void *data;
-	vkMapMemory(c.device, staging_buffer_memory, 0, static_cast<uint64_t>(size), 0, &data);
-	memcpy(data, elements, size);
-	vkUnmapMemory(c.device, staging_buffer_memory);
-
-	result = create_buffer(static_cast<uint64_t>(size), VK_BUFFER_USAGE_TRANSFER_DST_BIT | usage_type, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, render_buffer->buffer, render_buffer->memory);
-	if (!result) {
+	texture->sampler_index = SAMPLER_NEAREST_REPEAT;
+	texture->descriptor_index = bindless_register_texture(texture->image_view);
+	if (texture->descriptor_index == INVALID_DESCRIPTOR_INDEX) {
+		destroy_texture(texture);
 		return false;
 	}
 
-	result = copy_buffer(staging_buffer, render_buffer->buffer, size);
+	return true;
+}
+
+internal_function bool finish_texture(const Image_Upload *upload, VkImageViewType view_type, Texture *texture) {
+	bool result = upload_image_commit(upload);
 	if (!result) {
+		defer_destroy_image(texture->image, texture->memory);
 		return false;
 	}
+	texture->upload_value = upload_get_recording_value();
 
-	vkDestroyBuffer(c.device, staging_buffer, 0);
-	vkFreeMemory(c.device, staging_buffer_memory, 0);
-
-	return true;
+	return register_texture(texture, upload->format, view_type, upload->layer_count, upload->level_count);
 }
 
-internal_function bool create_texture(const char *texture_data, int width, int height, int nr_channels, Texture *texture, VkFormat format = VK_FORMAT_R8G8B8A8_SRGB) {
-	uint count = texture_asset_list.count;
-
+// data is the whole mip chain as upload_image takes it, in format
+internal_function bool create_texture_from_levels(const void *data, VkDeviceSize size, uint32 width, uint32 height, Texture *texture, VkFormat format, VkImageViewType view_type, uint32 layer_count, uint32 level_count) {
 	//
-	// create texture image and memory
-	// 
-	if (!texture_data) return false;
+	// create texture image and memory, the pixels get copied in when the upload batch is flushed
+	//
+	bool result = create_image(width, height, format, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, texture->image, texture->memory, layer_count, level_count);
+	if (!result) return false;
 
-	VkDeviceSize image_size = width * height * nr_channels;
+	result = upload_image(texture->image, format, width, height, data, size, layer_count, level_count);
+	if (!result) {
+		defer_destroy_image(texture->image, texture->memory);
+		return false;
+	}
+	texture->upload_value = upload_get_recording_value();
 
-	VkBuffer staging_buffer;
-	VkDeviceMemory staging_buffer_memory;
+	return register_texture(texture, format, view_type, layer_count, level_count);
+}
 
-	bool result = create_buffer(image_size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, staging_buffer, staging_buffer_memory);
-	if (!result) return false;
+// layer_count > 1 (or an array view type) makes an array texture, texture_data then holds the layers back to back.
+// mipmaps builds the whole mip chain from the pixels, only for the four byte formats.
+internal_function bool create_texture(const char *texture_data, int width, int height, Texture *texture, VkFormat format = VK_FORMAT_R8G8B8A8_SRGB, VkImageViewType view_type = VK_IMAGE_VIEW_TYPE_2D, uint32 layer_count = 1, bool mipmaps = false) {
+	if (!texture_data) return false;
 
-	void *data;
-	vkMapMemory(c.device, staging_buffer_memory, 0, image_size, 0, &data);
-	memcpy(data, texture_data, static_cast<size_t>(image_size));
-	vkUnmapMemory(c.device, staging_buffer_memory);
+	// NOTE: only the formats we actually load are in here; everything else is four bytes per texel
+	VkDeviceSize texel_size = format == VK_FORMAT_R8_UNORM ? 1 : 4;
+	VkDeviceSize image_size = width * height * texel_size * layer_count;
+	if (!mipmaps || texel_size != 4) {
+		return create_texture_from_levels(texture_data, image_size, static_cast<uint32>(width), static_cast<uint32>(height), texture, format, view_type, layer_count, 1);
+	}
 
-	result = create_image(width, height, format, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, texture->image, texture->memory);
+	//
+	// mip chain, level 0 is the pixels as they are and the rest is built in place in the staging memory
+	//
+	uint32 level_count = get_mip_level_count(width, height);
+	Image_Upload upload;
+	bool result = begin_texture(static_cast<uint32>(width), static_cast<uint32>(height), format, layer_count, level_count, texture, &upload);
 	if (!result) return false;
 
-	result = transition_image_layout(texture->image, format, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
-	if (!result) return false;
+	memcpy(upload.mapped, texture_data, static_cast<size_t>(image_size));
+	generate_mip_chain(static_cast<uint8 *>(upload.mapped), width, height, layer_count, level_count, format == VK_FORMAT_R8G8B8A8_SRGB);
 
-	result = copy_buffer_to_image(staging_buffer, texture->image, static_cast<uint32_t>(width), static_cast<uint32_t>(height));
-	if (!result) return false;
+	return finish_texture(&upload, view_type, texture);
+}
 
-	result = transition_image_layout(texture->image, format, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+// NOTE: the blocks go up as they are if the device samples their format, otherwise every level is decoded into
+// RGBA8 right in the staging memory; the result looks the same either way, only memory and bandwidth differ
+internal_function bool create_cooked_texture(const char *file_path, Texture *texture) {
+	Cooked_Texture cooked = {};
+	bool result = read_cooked_texture(file_path, &cooked);
 	if (!result) return false;
 
-	vkDestroyBuffer(c.device, staging_buffer, 0);
-	vkFreeMemory(c.device, staging_buffer_memory, 0);
-
-	//
-	// create texture image view
-	//
-	VkImageViewCreateInfo view_info = {
-		.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
-		.image = texture->image,
-		.viewType = VK_IMAGE_VIEW_TYPE_2D,
-		.format = format,
-		.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 }
-	};
-	VkResult vk_result = vkCreateImageView(c.device, &view_info, 0, &texture->image_view);
-	if (vk_result != VK_SUCCESS) return false;
+	VkFormat formats[TEXTURE_ENCODING_COUNT] = { VK_FORMAT_R8G8B8A8_SRGB, VK_FORMAT_BC1_RGBA_SRGB_BLOCK, VK_FORMAT_BC3_SRGB_BLOCK, VK_FORMAT_BC7_SRGB_BLOCK };
+	VkFormat format = formats[cooked.encoding];
+	if (cooked.encoding == TEXTURE_ENCODING_RGBA8 || is_format_sampleable(format)) {
+		result = create_texture_from_levels(cooked.levels, cooked.levels_size, cooked.width, cooked.height, texture, format, VK_IMAGE_VIEW_TYPE_2D, 1, cooked.level_count);
+	}
+	else {
+		Image_Upload upload;
+		result = begin_texture(cooked.width, cooked.height, VK_FORMAT_R8G8B8A8_SRGB, 1, cooked.level_count, texture, &upload);
+		if (result) {
+			const uint8 *blocks = cooked.levels;
+			uint8 *texels = static_cast<uint8 *>(upload.mapped);
+			for (uint32 level = 0; level < cooked.level_count; ++level) {
+				uint32 level_width = cooked.width >> level ? cooked.width >> level : 1;
+				uint32 level_height = cooked.height >> level ? cooked.height >> level : 1;
+				result = decode_texture_level(cooked.encoding, blocks, level_width, level_height, texels);
+				if (!result) break;
+				blocks += get_encoded_level_size(cooked.encoding, level_width, level_height);
+				texels += static_cast<size_t>(level_width) * level_height * 4;
+			}
+
+			if (result) {
+				result = finish_texture(&upload, VK_IMAGE_VIEW_TYPE_2D, texture);
+			}
+			else {
+				// the staging memory is never committed, nothing gets copied into the image
+				platform_log("Failed to decode '%s', it holds blocks the fallback decoder doesn't read!\n", file_path);
+				defer_destroy_image(texture->image, texture->memory);
+			}
+		}
+	}
 
-	//
-	// create texture image sampler
-	//
-	VkSamplerCreateInfo sampler_info = {
-		.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO,
-		.magFilter = VK_FILTER_NEAREST,
-		.minFilter = VK_FILTER_NEAREST,
-		.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST,
-		.addressModeU = VK_SAMPLER_ADDRESS_MODE_REPEAT,
-		.addressModeV = VK_SAMPLER_ADDRESS_MODE_REPEAT,
-		.addressModeW = VK_SAMPLER_ADDRESS_MODE_REPEAT,
-		.mipLodBias = 0.0f,
-		.anisotropyEnable = VK_FALSE,
-		.compareEnable = VK_FALSE,
-		.compareOp = VK_COMPARE_OP_ALWAYS,
-		.minLod = 0.0f,
-		.maxLod = 0.0f,
-		.borderColor = VK_BORDER_COLOR_INT_OPAQUE_BLACK,
-		.unnormalizedCoordinates = VK_FALSE
-	};
-	vk_result = vkCreateSampler(c.device, &sampler_info, 0, &texture->sampler);
-	if (vk_result != VK_SUCCESS) return false;
+	free_cooked_texture(&cooked);
+	return result;
+}
 
-	return true;
+internal_function bool has_extension(const char *file_path, const char *extension) {
+	size_t path_length = strlen(file_path), extension_length = strlen(extension);
+	return path_length >= extension_length && strcmp(file_path + path_length - extension_length, extension) == 0;
 }
 
 //
@@ -323,78 +222,182 @@ internal_function bool create_texture(const char *texture_data, int width, int h
 //
 
 bool create_texture_asset(const char *file_path, const Vertex *vertices, const uint *indices) {
-	uint count = texture_asset_list.count;
+	//
+	// create texture, cooked (.tex) or straight from the image
+	//
+	Texture texture = {};
+	bool result;
+	if (has_extension(file_path, ".tex")) {
+		result = create_cooked_texture(file_path, &texture);
+	}
+	else {
+		// NOTE: STBI_rgb_alpha always hands us 4 channels, no matter how many the file has
+		int width, height, nr_channels;
+		stbi_uc *pixels = stbi_load(file_path, &width, &height, &nr_channels, STBI_rgb_alpha);
+		if (!pixels) {
+			return false;
+		}
 
-	if (count == MAX_TEXTURE_BINDINGS) {
+		// NOTE: stb_image always decodes into a buffer of its own, that is the one copy into the staging memory
+		result = create_texture(reinterpret_cast<const char *>(pixels), width, height, &texture, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_VIEW_TYPE_2D, 1, true);
+		stbi_image_free(pixels);
+	}
+	if (!result) {
 		return false;
 	}
-	
-	int width, height, nr_channels;
-	stbi_uc *pixels = stbi_load(file_path, &width, &height, &nr_channels, STBI_rgb_alpha);
-	if (!pixels) {
+
+	//
+	// upload vertices and indices into the geometry buffer
+	//
+	Mesh mesh = {};
+	result = upload_mesh(vertices, 4, indices, 6, &mesh);
+	if (!result) {
+		destroy_texture(&texture);
 		return false;
 	}
 
-	VkFormat format;
-	switch (nr_channels) {
-		case 1: {
-			format = VK_FORMAT_R8_SRGB;
-			break;
-		}
-		case 2: {
-			format = VK_FORMAT_R8G8_SRGB;
-			break;
-		}
-		case 3: {
-			format = VK_FORMAT_R8G8B8_SRGB;
-			break;
+	texture_asset_list.textures.push_back(texture);
+	texture_asset_list.meshes.push_back(mesh);
+	texture_asset_list.labels.push_back(file_path);
+	++texture_asset_list.count;
+	return true;
+}
+
+bool create_sprite_family_asset(const char *const *file_paths, uint32 layer_count, Sprite_Family *family) {
+	if (layer_count == 0 || layer_count > MAX_SPRITE_FAMILY_LAYERS) {
+		platform_log("Sprite families need 1 to %u layers, got %u!\n", MAX_SPRITE_FAMILY_LAYERS, layer_count);
+		return false;
+	}
+
+	//
+	// sizes from the file headers, so the staging memory can be reserved before anything is decoded
+	//
+	int width = 0, height = 0;
+	for (uint32 layer = 0; layer < layer_count; ++layer) {
+		int layer_width, layer_height, nr_channels;
+		if (!stbi_info(file_paths[layer], &layer_width, &layer_height, &nr_channels)) {
+			platform_log("Failed to load sprite '%s'!\n", file_paths[layer]);
+			return false;
 		}
-		case 4: {
-			format = VK_FORMAT_R8G8B8A8_SRGB;
-			break;
+
+		if (layer == 0) {
+			width = layer_width;
+			height = layer_height;
 		}
-		default: {
+		else if (layer_width != width || layer_height != height) {
+			platform_log("Sprite '%s' is %dx%d, the rest of its family is %dx%d!\n", file_paths[layer], layer_width, layer_height, width, height);
 			return false;
 		}
 	}
 
 	//
-	// create texture
-	// 
-	bool result = create_texture(reinterpret_cast<const char *>(pixels), width, height, nr_channels, &texture_asset_list.textures[count], format);
+	// every layer goes into level 0 of the staging memory, back to back, the mip chain is built after them
+	//
+	Texture texture = {};
+	Image_Upload upload;
+	uint32 level_count = get_mip_level_count(width, height);
+	bool result = begin_texture(static_cast<uint32>(width), static_cast<uint32>(height), VK_FORMAT_R8G8B8A8_SRGB, layer_count, level_count, &texture, &upload);
 	if (!result) {
 		return false;
 	}
 
-	//
-	// create vertex buffer
-	//
-	result = create_render_buffer(vertices, 4 * sizeof(Vertex), &texture_asset_list.vertex_buffers[count], VERTEX_BUFFER);
-	if (!result) {
-		return false;
+	size_t layer_size = static_cast<size_t>(width) * height * 4;
+	for (uint32 layer = 0; layer < layer_count; ++layer) {
+		int layer_width, layer_height, nr_channels;
+		stbi_uc *pixels = stbi_load(file_paths[layer], &layer_width, &layer_height, &nr_channels, STBI_rgb_alpha);
+		if (!pixels || layer_width != width || layer_height != height) {
+			platform_log("Failed to load sprite '%s'!\n", file_paths[layer]);
+			stbi_image_free(pixels);
+			defer_destroy_image(texture.image, texture.memory);
+			return false;
+		}
+
+		memcpy(static_cast<uint8 *>(upload.mapped) + layer * layer_size, pixels, layer_size);
+		stbi_image_free(pixels);
 	}
+	generate_mip_chain(static_cast<uint8 *>(upload.mapped), width, height, layer_count, level_count, true);
 
-	//
-	// create index buffer
-	//
-	result = create_render_buffer(indices, 6 * sizeof(uint), &texture_asset_list.index_buffers[count], INDEX_BUFFER);
+	result = finish_texture(&upload, VK_IMAGE_VIEW_TYPE_2D_ARRAY, &texture);
 	if (!result) {
 		return false;
 	}
 
-	++texture_asset_list.count;
+	texture_asset_list.sprite_families.push_back(texture);
+	texture_asset_list.sprite_family_labels.push_back(file_paths[0]);
+
+	family->descriptor_index = texture.descriptor_index;
+	family->layer_count = layer_count;
+	family->upload_value = texture.upload_value;
+	return true;
+}
+
+bool create_texture_from_pixels(const void *pixels, uint32 width, uint32 height, VkFormat format, Texture *texture) {
+	return create_texture(static_cast<const char *>(pixels), static_cast<int>(width), static_cast<int>(height), texture, format);
+}
+
+bool create_texture_array_from_pixels(const void *pixels, uint32 width, uint32 height, uint32 layer_count, Texture *texture) {
+	return create_texture(static_cast<const char *>(pixels), static_cast<int>(width), static_cast<int>(height), texture, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_VIEW_TYPE_2D_ARRAY, layer_count);
+}
+
+bool create_empty_texture(uint32 width, uint32 height, VkFormat format, Sampler_Id sampler, Texture *texture) {
+	bool result = create_image(width, height, format, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, texture->image, texture->memory);
+	if (!result) return false;
+
+	result = register_texture(texture, format, VK_IMAGE_VIEW_TYPE_2D, 1, 1);
+	if (!result) return false;
+
+	texture->sampler_index = sampler;
 	return true;
 }
 
-void delete_texture_asset(const char *label) {
-	// @ToDo
+void destroy_texture(Texture *texture) {
+	// the descriptor first, so its slot is only reused once the frames that sampled through it are done
+	defer_unregister_texture(texture->descriptor_index);
+	defer_destroy_image_view(texture->image_view);
+	defer_destroy_image(texture->image, texture->memory);
+	*texture = {};
+	texture->descriptor_index = INVALID_DESCRIPTOR_INDEX;
+}
+
+bool delete_texture_asset(const char *label) {
+	for (uint i = 0; i < texture_asset_list.count; ++i) {
+		if (texture_asset_list.labels[i] != label) continue;
+
+		destroy_texture(&texture_asset_list.textures[i]);
+		defer_free_mesh(texture_asset_list.meshes[i]);
+		texture_asset_list.textures.erase(texture_asset_list.textures.begin() + i);
+		texture_asset_list.meshes.erase(texture_asset_list.meshes.begin() + i);
+		texture_asset_list.labels.erase(texture_asset_list.labels.begin() + i);
+		--texture_asset_list.count;
+		return true;
+	}
+
+	for (size_t i = 0; i < texture_asset_list.sprite_families.size(); ++i) {
+		if (texture_asset_list.sprite_family_labels[i] != label) continue;
+
+		destroy_texture(&texture_asset_list.sprite_families[i]);
+		texture_asset_list.sprite_families.erase(texture_asset_list.sprite_families.begin() + i);
+		texture_asset_list.sprite_family_labels.erase(texture_asset_list.sprite_family_labels.begin() + i);
+		return true;
+	}
+
+	return false;
+}
+
+void delete_all_texture_assets() {
+	for (Texture &texture : texture_asset_list.textures) {
+		destroy_texture(&texture);
+	}
+	for (Texture &texture : texture_asset_list.sprite_families) {
+		destroy_texture(&texture);
+	}
+	texture_asset_list = {};
 }
 
 Texture_Asset get_next_texture_asset(uint *index) {
 	Texture_Asset texture_asset = {};
 	texture_asset.texture = texture_asset_list.textures[*index];
-	texture_asset.vertex_buffer = texture_asset_list.vertex_buffers[*index];
-	texture_asset.index_buffer = texture_asset_list.index_buffers[*index];
+	texture_asset.mesh = texture_asset_list.meshes[*index];
 	++(*index);
 	return texture_asset;
 }
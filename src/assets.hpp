@@ -3,6 +3,8 @@
 
 #include "types.hpp"
 #include "math.hpp"
+#include "renderer/vulkan_memory.hpp"
+#include "renderer/samplers.hpp"
 
 #include <vulkan/vulkan.h>
 
@@ -12,9 +14,11 @@
 
 struct Texture {
 	VkImage image;
-	VkDeviceMemory memory;
+	Memory_Allocation memory;
 	VkImageView image_view;
-	VkSampler sampler;
+	uint32 descriptor_index; // into the bindless texture array
+	uint32 sampler_index; // a Sampler_Id, shaders get it next to the descriptor index
+	uint64 upload_value; // nothing may sample it before upload_is_acquired(upload_value)
 };
 
 enum Buffer_Type {
@@ -25,13 +29,20 @@ enum Buffer_Type {
 struct Render_Buffer {
 	Buffer_Type type;
 	VkBuffer buffer;
-	VkDeviceMemory memory;
+	Memory_Allocation memory;
+};
+
+struct Mesh {
+	uint32 index_count;
+	uint32 first_index;
+	int32 vertex_offset;
+	uint32 vertex_count; // to give the vertices back to the geometry buffer
+	uint64 upload_value; // 0 if it was written directly, otherwise nothing may draw it before upload_is_acquired
 };
 
 struct Texture_Asset { // @Optimization: SoA vs AoS
 	Texture texture;
-	Render_Buffer vertex_buffer;
-	Render_Buffer index_buffer;
+	Mesh mesh;
 };
 
 struct Vertex {
@@ -39,8 +50,34 @@ struct Vertex {
 	Vec2 tex_coord;
 };
 
+// NOTE: equal sized sprites (animation frames, tiles, variants) packed into the layers of one 2D array texture.
+// Which layer is drawn is per instance (see sprites.hpp), so the whole family shares one descriptor.
+constexpr uint32 MAX_SPRITE_FAMILY_LAYERS = 256; // the guaranteed minimum of maxImageArrayLayers
+
+struct Sprite_Family {
+	uint32 descriptor_index; // a 2D array view in the bindless texture array
+	uint32 layer_count;
+	uint64 upload_value; // see Texture
+};
+
+// file_path is a cooked .tex file (texture_compression.hpp) or any image stbi reads
 bool create_texture_asset(const char *file_path, const Vertex *vertices, const uint *indices);
-void delete_texture_asset(const char *label);
+// pixels are tightly packed, R8_UNORM or one of the four byte formats; has to run inside an upload batch
+// every file becomes one layer, in order; they all have to be the same size. The files are the label, the first
+// one is what delete_texture_asset matches.
+bool create_sprite_family_asset(const char *const *file_paths, uint32 layer_count, Sprite_Family *family);
+bool create_texture_from_pixels(const void *pixels, uint32 width, uint32 height, VkFormat format, Texture *texture);
+// layer_count layers of tightly packed RGBA8 sRGB pixels back to back, always a 2D array view; inside an upload batch.
+// No mip chain, smaller levels would blend neighbouring atlas sprites into each other.
+bool create_texture_array_from_pixels(const void *pixels, uint32 width, uint32 height, uint32 layer_count, Texture *texture);
+// contents and layout are undefined, whoever fills it is responsible for the transitions (e.g. a render graph pass)
+bool create_empty_texture(uint32 width, uint32 height, VkFormat format, Sampler_Id sampler, Texture *texture);
+// NOTE: destruction goes through the deletion queue, frames in flight can keep drawing the texture
+void destroy_texture(Texture *texture);
+// label is the file path the asset (or the first file of the sprite family) was created from; false if there is
+// no such asset
+bool delete_texture_asset(const char *label);
+void delete_all_texture_assets();
 
 Texture_Asset get_next_texture_asset(uint *index);
 uint get_texture_asset_count();
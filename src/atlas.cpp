@@ -0,0 +1,404 @@
+#include "atlas.hpp"
+
+#include "platform.hpp"
+#include "assets.hpp"
+
+#include <lib/stb_image.h>
+
+#include <string.h>
+
+#include <algorithm>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+//
+// Internal
+//
+
+constexpr uint32 ATLAS_FILE_MAGIC = 0x534C5441; // "ATLS"
+constexpr uint32 ATLAS_FILE_VERSION = 1;
+constexpr uint32 MIN_ATLAS_PAGE_SIZE = 64;
+constexpr uint32 ATLAS_BORDER = 1; // texels around every sprite that repeat its edge
+
+// NOTE: a cooked atlas is the header, sprite_count Atlas_File_Sprites and then page_count pages of
+// page_size * page_size RGBA8 texels
+struct Atlas_File_Header {
+	uint32 magic;
+	uint32 version;
+	uint32 page_size;
+	uint32 page_count;
+	uint32 sprite_count;
+};
+
+struct Atlas_File_Sprite {
+	char name[ATLAS_SPRITE_NAME_LENGTH];
+	uint32 page;
+	uint32 x; // texels, the border is around this rect
+	uint32 y;
+	uint32 width;
+	uint32 height;
+};
+
+struct Packed_Atlas {
+	uint32 page_size;
+	uint32 page_count;
+	std::vector<Atlas_File_Sprite> sprites;
+	std::vector<uint8> pixels; // page after page
+};
+
+struct Atlas_Source {
+	std::string name;
+	stbi_uc *pixels;
+	uint32 width;
+	uint32 height;
+};
+
+// the skyline of a page: the top edge of everything placed so far, left to right, always covers the whole width
+struct Skyline_Node {
+	uint32 x;
+	uint32 y;
+	uint32 width;
+};
+
+struct Sprite_Atlases {
+	std::vector<Texture> textures;
+	std::unordered_map<std::string, Atlas_Sprite> sprites;
+};
+
+global_variable Sprite_Atlases sprite_atlases = {};
+
+internal_function void collect_png(const char *file_name, void *user_data) {
+	std::vector<std::string> *file_names = static_cast<std::vector<std::string> *>(user_data);
+
+	size_t length = strlen(file_name);
+	if (length > 4 && (strcmp(file_name + length - 4, ".png") == 0 || strcmp(file_name + length - 4, ".PNG") == 0)) {
+		file_names->push_back(file_name);
+	}
+}
+
+internal_function void free_atlas_sources(std::vector<Atlas_Source> *sources) {
+	for (Atlas_Source &source : *sources) {
+		stbi_image_free(source.pixels);
+	}
+	sources->clear();
+}
+
+internal_function bool load_atlas_sources(const char *directory, std::vector<Atlas_Source> *sources) {
+	std::vector<std::string> file_names;
+	bool result = platform_list_directory(directory, collect_png, &file_names);
+	if (!result) {
+		platform_log("Failed to list the sprites in '%s'!\n", directory);
+		return false;
+	}
+
+	// the listing order depends on the file system, sorted the same directory always packs the same way
+	std::sort(file_names.begin(), file_names.end());
+
+	for (const std::string &file_name : file_names) {
+		std::string name = file_name.substr(0, file_name.size() - 4);
+		if (name.size() >= ATLAS_SPRITE_NAME_LENGTH) {
+			platform_log("Sprite name '%s' is longer than %u characters!\n", name.c_str(), ATLAS_SPRITE_NAME_LENGTH - 1);
+			free_atlas_sources(sources);
+			return false;
+		}
+
+		std::string path = std::string(directory) + "/" + file_name;
+		int width, height, nr_channels;
+		stbi_uc *pixels = stbi_load(path.c_str(), &width, &height, &nr_channels, STBI_rgb_alpha);
+		if (!pixels) {
+			platform_log("Failed to load sprite '%s'!\n", path.c_str());
+			free_atlas_sources(sources);
+			return false;
+		}
+
+		sources->push_back({ name, pixels, static_cast<uint32>(width), static_cast<uint32>(height) });
+	}
+
+	return true;
+}
+
+// bottom left: the position where the rect's bottom ends up lowest; false if it doesn't fit anywhere
+internal_function bool skyline_find(const std::vector<Skyline_Node> &skyline, uint32 page_size, uint32 width, uint32 height, uint32 *node_index, uint32 *x, uint32 *y) {
+	bool found = false;
+	uint32 best_bottom = 0;
+
+	for (uint32 i = 0; i < skyline.size(); ++i) {
+		uint32 left = skyline[i].x;
+		if (left + width > page_size) break;
+
+		// the rect rests on the highest node it spans
+		uint32 top = 0;
+		uint32 width_left = width;
+		for (uint32 j = i; width_left > 0; ++j) {
+			top = std::max(top, skyline[j].y);
+			if (skyline[j].width >= width_left) break;
+			width_left -= skyline[j].width;
+		}
+		if (top + height > page_size) continue;
+
+		if (!found || top + height < best_bottom) {
+			found = true;
+			best_bottom = top + height;
+			*node_index = i;
+			*x = left;
+			*y = top;
+		}
+	}
+
+	return found;
+}
+
+internal_function void skyline_place(std::vector<Skyline_Node> *skyline, uint32 node_index, uint32 x, uint32 y, uint32 width, uint32 height) {
+	skyline->insert(skyline->begin() + node_index, { x, y + height, width });
+
+	// the nodes the rect covers shrink or go away
+	for (uint32 i = node_index + 1; i < skyline->size();) {
+		Skyline_Node &node = (*skyline)[i];
+		uint32 right = x + width;
+		if (node.x >= right) break;
+
+		uint32 covered = right - node.x;
+		if (node.width <= covered) {
+			skyline->erase(skyline->begin() + i);
+			continue;
+		}
+		node.x += covered;
+		node.width -= covered;
+		break;
+	}
+
+	// neighbours at the same height become one node
+	for (uint32 i = 0; i + 1 < skyline->size();) {
+		if ((*skyline)[i].y == (*skyline)[i + 1].y) {
+			(*skyline)[i].width += (*skyline)[i + 1].width;
+			skyline->erase(skyline->begin() + i + 1);
+			continue;
+		}
+		++i;
+	}
+}
+
+// sources are placed in the given order (tallest first packs best), the rects include the border
+internal_function bool pack_pages(const std::vector<Atlas_Source> &sources, const std::vector<uint32> &order, uint32 page_size, uint32 max_pages, std::vector<Atlas_File_Sprite> *sprites, uint32 *page_count) {
+	std::vector<std::vector<Skyline_Node>> pages;
+	sprites->assign(sources.size(), {});
+
+	for (uint32 source_index : order) {
+		const Atlas_Source &source = sources[source_index];
+		uint32 width = source.width + 2 * ATLAS_BORDER;
+		uint32 height = source.height + 2 * ATLAS_BORDER;
+		if (width > page_size || height > page_size) return false;
+
+		bool placed = false;
+		for (uint32 page = 0; page <= pages.size() && !placed; ++page) {
+			if (page == pages.size()) {
+				if (pages.size() == max_pages) return false;
+				pages.push_back({ { 0, 0, page_size } });
+			}
+
+			uint32 node_index, x, y;
+			if (!skyline_find(pages[page], page_size, width, height, &node_index, &x, &y)) continue;
+			skyline_place(&pages[page], node_index, x, y, width, height);
+
+			Atlas_File_Sprite &sprite = (*sprites)[source_index];
+			memcpy(sprite.name, source.name.c_str(), source.name.size() + 1);
+			sprite.page = page;
+			sprite.x = x + ATLAS_BORDER;
+			sprite.y = y + ATLAS_BORDER;
+			sprite.width = source.width;
+			sprite.height = source.height;
+			placed = true;
+		}
+	}
+
+	*page_count = static_cast<uint32>(pages.size());
+	return true;
+}
+
+internal_function bool pack_atlas(const char *directory, Packed_Atlas *atlas) {
+	std::vector<Atlas_Source> sources;
+	bool result = load_atlas_sources(directory, &sources);
+	if (!result) return false;
+	if (sources.empty()) {
+		platform_log("No sprites in '%s'!\n", directory);
+		return false;
+	}
+
+	std::vector<uint32> order(sources.size());
+	for (uint32 i = 0; i < order.size(); ++i) order[i] = i;
+	std::stable_sort(order.begin(), order.end(), [&](uint32 a, uint32 b) { return sources[a].height > sources[b].height; });
+
+	// the smallest single page everything fits on, more pages of the biggest size only if nothing does
+	bool packed = false;
+	for (uint32 page_size = MIN_ATLAS_PAGE_SIZE; page_size <= MAX_ATLAS_PAGE_SIZE && !packed; page_size *= 2) {
+		packed = pack_pages(sources, order, page_size, 1, &atlas->sprites, &atlas->page_count);
+		atlas->page_size = page_size;
+	}
+	if (!packed) {
+		atlas->page_size = MAX_ATLAS_PAGE_SIZE;
+		packed = pack_pages(sources, order, MAX_ATLAS_PAGE_SIZE, MAX_ATLAS_PAGES, &atlas->sprites, &atlas->page_count);
+	}
+	if (!packed) {
+		platform_log("The sprites in '%s' don't fit into %u pages of %ux%u!\n", directory, MAX_ATLAS_PAGES, MAX_ATLAS_PAGE_SIZE, MAX_ATLAS_PAGE_SIZE);
+		free_atlas_sources(&sources);
+		return false;
+	}
+
+	//
+	// copy every sprite into its page, the border repeats the nearest edge texel
+	//
+	size_t page_texels = static_cast<size_t>(atlas->page_size) * atlas->page_size;
+	atlas->pixels.assign(page_texels * atlas->page_count * 4, 0);
+
+	for (uint32 i = 0; i < sources.size(); ++i) {
+		const Atlas_Source &source = sources[i];
+		const Atlas_File_Sprite &sprite = atlas->sprites[i];
+		uint8 *page = atlas->pixels.data() + sprite.page * page_texels * 4;
+
+		for (uint32 y = 0; y < source.height + 2 * ATLAS_BORDER; ++y) {
+			uint32 source_y = std::min(std::max(y, ATLAS_BORDER) - ATLAS_BORDER, source.height - 1);
+			for (uint32 x = 0; x < source.width + 2 * ATLAS_BORDER; ++x) {
+				uint32 source_x = std::min(std::max(x, ATLAS_BORDER) - ATLAS_BORDER, source.width - 1);
+				size_t destination = (static_cast<size_t>(sprite.y - ATLAS_BORDER + y) * atlas->page_size + sprite.x - ATLAS_BORDER + x) * 4;
+				memcpy(page + destination, source.pixels + (static_cast<size_t>(source_y) * source.width + source_x) * 4, 4);
+			}
+		}
+	}
+
+	free_atlas_sources(&sources);
+	return true;
+}
+
+internal_function bool register_atlas(uint32 page_size, uint32 page_count, const Atlas_File_Sprite *sprites, uint32 sprite_count, const void *pixels) {
+	Texture texture = {};
+	bool result = create_texture_array_from_pixels(pixels, page_size, page_size, page_count, &texture);
+	if (!result) return false;
+	sprite_atlases.textures.push_back(texture);
+
+	real32 texel = 1.0f / static_cast<real32>(page_size);
+	for (uint32 i = 0; i < sprite_count; ++i) {
+		const Atlas_File_Sprite &sprite = sprites[i];
+		sprite_atlases.sprites[sprite.name] = {
+			.descriptor_index = texture.descriptor_index,
+			.layer = sprite.page,
+			.uv_min = { sprite.x * texel, sprite.y * texel },
+			.uv_max = { (sprite.x + sprite.width) * texel, (sprite.y + sprite.height) * texel },
+			.width = sprite.width,
+			.height = sprite.height,
+			.upload_value = texture.upload_value,
+		};
+	}
+
+	return true;
+}
+
+//
+// Exported
+//
+
+bool cook_sprite_atlas(const char *directory, const char *atlas_path) {
+	Packed_Atlas atlas = {};
+	bool result = pack_atlas(directory, &atlas);
+	if (!result) return false;
+
+	Atlas_File_Header header = {
+		.magic = ATLAS_FILE_MAGIC,
+		.version = ATLAS_FILE_VERSION,
+		.page_size = atlas.page_size,
+		.page_count = atlas.page_count,
+		.sprite_count = static_cast<uint32>(atlas.sprites.size()),
+	};
+
+	size_t sprites_size = atlas.sprites.size() * sizeof(Atlas_File_Sprite);
+	size_t file_size = sizeof(header) + sprites_size + atlas.pixels.size();
+	if (file_size > UINT32_MAX) {
+		platform_log("The atlas of '%s' is too big for one file!\n", directory);
+		return false;
+	}
+
+	std::vector<uint8> file(file_size);
+	memcpy(file.data(), &header, sizeof(header));
+	memcpy(file.data() + sizeof(header), atlas.sprites.data(), sprites_size);
+	memcpy(file.data() + sizeof(header) + sprites_size, atlas.pixels.data(), atlas.pixels.size());
+
+	result = platform_write_file(atlas_path, file.data(), static_cast<uint32>(file_size));
+	if (!result) {
+		platform_log("Failed to write the atlas '%s'!\n", atlas_path);
+		return false;
+	}
+
+	platform_log("Cooked %u sprites into %u pages of %ux%u: %s\n", header.sprite_count, header.page_count, header.page_size, header.page_size, atlas_path);
+	return true;
+}
+
+bool create_sprite_atlas_asset(const char *atlas_path) {
+	File_Asset file = {};
+	uint32 size = platform_read_file(atlas_path, &file);
+	if (size < sizeof(Atlas_File_Header)) {
+		if (size > 0) platform_free_file(&file);
+		platform_log("Failed to read the atlas '%s'!\n", atlas_path);
+		return false;
+	}
+
+	Atlas_File_Header header;
+	memcpy(&header, file.data, sizeof(header));
+
+	uint64 sprites_size = static_cast<uint64>(header.sprite_count) * sizeof(Atlas_File_Sprite);
+	uint64 pixels_size = static_cast<uint64>(header.page_size) * header.page_size * header.page_count * 4;
+	bool valid = header.magic == ATLAS_FILE_MAGIC &&
+		header.version == ATLAS_FILE_VERSION &&
+		header.page_size > 0 && header.page_size <= MAX_ATLAS_PAGE_SIZE &&
+		header.page_count > 0 && header.page_count <= MAX_ATLAS_PAGES &&
+		size == sizeof(header) + sprites_size + pixels_size;
+	if (!valid) {
+		platform_log("'%s' is not an atlas of this version!\n", atlas_path);
+		platform_free_file(&file);
+		return false;
+	}
+
+	// NOTE: the file is only byte aligned, the table gets copied out before anything reads it
+	std::vector<Atlas_File_Sprite> sprites(header.sprite_count);
+	memcpy(sprites.data(), file.data + sizeof(header), static_cast<size_t>(sprites_size));
+	for (Atlas_File_Sprite &sprite : sprites) {
+		sprite.name[ATLAS_SPRITE_NAME_LENGTH - 1] = 0;
+
+		// the rect and its border have to lie on an existing page, 64 bit so huge sizes can't wrap around
+		bool inside = sprite.page < header.page_count &&
+			sprite.x >= ATLAS_BORDER && sprite.y >= ATLAS_BORDER &&
+			static_cast<uint64>(sprite.x) + sprite.width + ATLAS_BORDER <= header.page_size &&
+			static_cast<uint64>(sprite.y) + sprite.height + ATLAS_BORDER <= header.page_size;
+		if (!inside) {
+			platform_log("Sprite '%s' in the atlas '%s' lies outside of its page!\n", sprite.name, atlas_path);
+			platform_free_file(&file);
+			return false;
+		}
+	}
+
+	bool result = register_atlas(header.page_size, header.page_count, sprites.data(), header.sprite_count, file.data + sizeof(header) + sprites_size);
+	platform_free_file(&file);
+	return result;
+}
+
+bool create_sprite_atlas_from_directory(const char *directory) {
+	Packed_Atlas atlas = {};
+	bool result = pack_atlas(directory, &atlas);
+	if (!result) return false;
+
+	return register_atlas(atlas.page_size, atlas.page_count, atlas.sprites.data(), static_cast<uint32>(atlas.sprites.size()), atlas.pixels.data());
+}
+
+void delete_all_sprite_atlases() {
+	for (Texture &texture : sprite_atlases.textures) {
+		destroy_texture(&texture);
+	}
+	sprite_atlases = {};
+}
+
+bool get_atlas_sprite(const char *name, Atlas_Sprite *sprite) {
+	auto it = sprite_atlases.sprites.find(name);
+	if (it == sprite_atlases.sprites.end()) return false;
+
+	*sprite = it->second;
+	return true;
+}
@@ -0,0 +1,42 @@
+#ifndef ATLAS_H
+#define ATLAS_H
+
+#include "types.hpp"
+#include "math.hpp"
+
+// NOTE: hundreds of small sprites share a handful of textures instead of one texture each. All pngs of a directory
+// are packed with a skyline packer into square pages; the pages are the layers of one array texture, so a whole
+// atlas is one bindless descriptor and its sprites batch with each other and with sprite families (sprites.hpp).
+// Every sprite gets a one texel border that repeats its edge, filtering never pulls in a neighbour.
+//
+// Offline, cook_sprite_atlas writes the packed pages and the sprite table into one .atlas file (the linux build
+// has -cook_atlas for it); at runtime create_sprite_atlas_asset loads that file. During development
+// create_sprite_atlas_from_directory packs the pngs at startup instead, the result is the same.
+constexpr uint32 MAX_ATLAS_PAGE_SIZE = 4096;
+constexpr uint32 MAX_ATLAS_PAGES = 16; // keeps a cooked atlas (RGBA8 pages) below 4 GB
+constexpr uint32 ATLAS_SPRITE_NAME_LENGTH = 64; // with the terminator
+
+// a sub rect of an atlas page, what draw_atlas_sprite takes
+struct Atlas_Sprite {
+	uint32 descriptor_index; // of the atlas' array texture
+	uint32 layer;            // the page
+	Vec2 uv_min;
+	Vec2 uv_max;
+	uint32 width;            // texels
+	uint32 height;
+	uint64 upload_value;     // of the atlas' texture, see Texture
+};
+
+// false if a png can't be loaded, one is bigger than a page or they don't fit into MAX_ATLAS_PAGES pages
+bool cook_sprite_atlas(const char *directory, const char *atlas_path);
+
+// both have to run inside an upload batch; sprites are named after their file without the extension and a name
+// that is already taken replaces the older sprite
+bool create_sprite_atlas_asset(const char *atlas_path);
+bool create_sprite_atlas_from_directory(const char *directory);
+// the textures go through the deletion queue
+void delete_all_sprite_atlases();
+
+bool get_atlas_sprite(const char *name, Atlas_Sprite *sprite);
+
+#endif
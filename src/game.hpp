@@ -18,6 +18,10 @@ struct Game_State {
 		Vec2 position;
 		real32 speed;
 	} player; // @Cleanup: player in Game_State?!
+	struct {
+		Vec2 position;
+		real32 half_height; // world units from the center of the screen to its top edge
+	} camera;
 };
 
 struct Game_Memory {
@@ -27,10 +31,21 @@ struct Game_Memory {
 	void *transient_storage;
 };
 
+constexpr uint32 MAX_GPU_TIMINGS = 32;
+
+struct Gpu_Timing {
+	const char *name;
+	real64 ms;
+};
+
 struct Perf_Metrics {
-	real64 ms_per_frame;
+	real64 ms_per_frame; // cpu, wall time
 	real64 fps;
 	real64 mcpf;
+	// NOTE: gpu timings lag the number of frames in flight behind, they are read once the frame's fence retired
+	real64 gpu_ms_per_frame;
+	uint32 gpu_timing_count;
+	Gpu_Timing gpu_timings[MAX_GPU_TIMINGS]; // render graph passes and draw ranges, in the order they began
 };
 
 extern Perf_Metrics perf_metrics;
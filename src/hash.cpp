@@ -0,0 +1,22 @@
+#include "hash.hpp"
+
+constexpr uint64 HASH_PRIME = 1099511628211ull;
+
+uint64 hash_bytes(const void *data, size_t size, uint64 hash) {
+	const uint8 *bytes = static_cast<const uint8 *>(data);
+	for (size_t i = 0; i < size; ++i) {
+		hash ^= bytes[i];
+		hash *= HASH_PRIME;
+	}
+	return hash;
+}
+
+uint64 hash_string(const char *text, uint64 hash, uint32 *length) {
+	const char *ch = text;
+	for (; *ch; ++ch) {
+		hash ^= static_cast<uint8>(*ch);
+		hash *= HASH_PRIME;
+	}
+	if (length) *length = static_cast<uint32>(ch - text);
+	return hash;
+}
@@ -0,0 +1,18 @@
+#ifndef HASH_H
+#define HASH_H
+
+#include "types.hpp"
+
+#include <stddef.h>
+
+// NOTE: FNV-1a, one byte at a time. Good enough for hash maps, dedup keys and file checksums, not for anything
+// an attacker controls. Pieces that aren't next to each other in memory are hashed one after the other by
+// passing the previous result as hash.
+
+constexpr uint64 HASH_SEED = 14695981039346656037ull;
+
+uint64 hash_bytes(const void *data, size_t size, uint64 hash = HASH_SEED);
+// up to and without the terminating zero, length gets the string length if it isn't null
+uint64 hash_string(const char *text, uint64 hash = HASH_SEED, uint32 *length = 0);
+
+#endif
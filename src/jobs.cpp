@@ -0,0 +1,116 @@
+#include "jobs.hpp"
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//
+// Internal
+//
+
+struct Job {
+	Job_Function function;
+	void *data;
+	Job_Counter *counter;
+};
+
+struct Job_System {
+	std::mutex mutex;
+	std::condition_variable job_available;
+	std::condition_variable job_finished;
+	std::deque<Job> queue;
+	std::vector<std::thread> workers;
+	bool running;
+};
+
+global_variable Job_System job_system;
+
+internal_function void run_job(const Job &job) {
+	job.function(job.data);
+
+	if (job.counter) {
+		// take the lock so a waiter can't check the counter and go to sleep between the decrement and the notify
+		std::lock_guard<std::mutex> lock(job_system.mutex);
+		--job.counter->pending;
+	}
+	job_system.job_finished.notify_all();
+}
+
+internal_function void worker_main() {
+	for (;;) {
+		Job job;
+		{
+			std::unique_lock<std::mutex> lock(job_system.mutex);
+			job_system.job_available.wait(lock, [] { return !job_system.running || !job_system.queue.empty(); });
+			if (job_system.queue.empty()) return; // only happens on shutdown
+
+			job = job_system.queue.front();
+			job_system.queue.pop_front();
+		}
+		run_job(job);
+	}
+}
+
+//
+// Exported
+//
+
+bool jobs_init(uint32 worker_count) {
+	if (worker_count == 0) {
+		uint32 hardware_threads = std::thread::hardware_concurrency();
+		worker_count = hardware_threads > 1 ? hardware_threads - 1 : 1;
+	}
+
+	job_system.running = true;
+	for (uint32 i = 0; i < worker_count; ++i) {
+		job_system.workers.emplace_back(worker_main);
+	}
+
+	return true;
+}
+
+void jobs_shutdown() {
+	{
+		std::lock_guard<std::mutex> lock(job_system.mutex);
+		job_system.running = false;
+	}
+	job_system.job_available.notify_all();
+
+	for (std::thread &worker : job_system.workers) {
+		worker.join();
+	}
+	job_system.workers.clear();
+}
+
+uint32 jobs_get_worker_count() {
+	return static_cast<uint32>(job_system.workers.size());
+}
+
+void jobs_submit(Job_Function function, void *data, Job_Counter *counter) {
+	{
+		std::lock_guard<std::mutex> lock(job_system.mutex);
+		if (counter) ++counter->pending;
+		job_system.queue.push_back({ function, data, counter });
+	}
+	job_system.job_available.notify_one();
+}
+
+void jobs_wait(Job_Counter *counter) {
+	std::unique_lock<std::mutex> lock(job_system.mutex);
+	while (counter->pending > 0) {
+		if (!job_system.queue.empty()) {
+			// help out instead of sleeping
+			Job job = job_system.queue.front();
+			job_system.queue.pop_front();
+
+			lock.unlock();
+			run_job(job);
+			lock.lock();
+			continue;
+		}
+
+		job_system.job_finished.wait(lock);
+	}
+}
@@ -0,0 +1,24 @@
+#ifndef JOBS_H
+#define JOBS_H
+
+#include "types.hpp"
+
+#include <atomic>
+
+// NOTE: a small fixed pool of worker threads. Jobs are fire and forget, anything that needs to know when a
+// group of jobs finished passes a Job_Counter and waits on it; the waiting thread runs queued jobs meanwhile,
+// so waiting from inside a job can't deadlock the pool.
+typedef void (*Job_Function)(void *data);
+
+struct Job_Counter {
+	std::atomic<uint32> pending;
+};
+
+bool jobs_init(uint32 worker_count = 0); // 0 picks one worker per hardware thread minus the main thread
+void jobs_shutdown();
+uint32 jobs_get_worker_count();
+
+void jobs_submit(Job_Function function, void *data, Job_Counter *counter);
+void jobs_wait(Job_Counter *counter);
+
+#endif
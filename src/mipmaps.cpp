@@ -0,0 +1,155 @@
+#include "mipmaps.hpp"
+
+#include <math.h>
+#include <string.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MIPMAPS_SSE2 1
+#include <emmintrin.h>
+#endif
+
+//
+// Internal
+//
+
+// NOTE: 4096 steps from linear back to sRGB are fine enough that no 8 bit value gets lost next to black
+struct Srgb_Tables {
+	real32 to_linear[256];
+	uint8 from_linear[4096];
+};
+
+internal_function Srgb_Tables build_srgb_tables() {
+	Srgb_Tables tables = {};
+	for (uint32 i = 0; i < 256; ++i) {
+		real32 value = i / 255.0f;
+		tables.to_linear[i] = value <= 0.04045f ? value / 12.92f : powf((value + 0.055f) / 1.055f, 2.4f);
+	}
+	for (uint32 i = 0; i < 4096; ++i) {
+		real32 value = i / 4095.0f;
+		real32 srgb = value <= 0.0031308f ? value * 12.92f : 1.055f * powf(value, 1.0f / 2.4f) - 0.055f;
+		tables.from_linear[i] = static_cast<uint8>(srgb * 255.0f + 0.5f);
+	}
+	return tables;
+}
+
+internal_function const Srgb_Tables &get_srgb_tables() {
+	local_persist Srgb_Tables tables = build_srgb_tables(); // built on first use, the initialization is thread safe
+	return tables;
+}
+
+// one output texel from four input texels; color in linear space, alpha as is
+internal_function void average_srgb(const Srgb_Tables &tables, const uint8 *a, const uint8 *b, const uint8 *c, const uint8 *d, uint8 *out) {
+#if MIPMAPS_SSE2
+	__m128 sum = _mm_set_ps(a[3], tables.to_linear[a[2]], tables.to_linear[a[1]], tables.to_linear[a[0]]);
+	sum = _mm_add_ps(sum, _mm_set_ps(b[3], tables.to_linear[b[2]], tables.to_linear[b[1]], tables.to_linear[b[0]]));
+	sum = _mm_add_ps(sum, _mm_set_ps(c[3], tables.to_linear[c[2]], tables.to_linear[c[1]], tables.to_linear[c[0]]));
+	sum = _mm_add_ps(sum, _mm_set_ps(d[3], tables.to_linear[d[2]], tables.to_linear[d[1]], tables.to_linear[d[0]]));
+
+	// color scaled to the table, alpha is still 0 to 255; cvtps rounds to nearest
+	__m128 scale = _mm_set_ps(0.25f, 0.25f * 4095.0f, 0.25f * 4095.0f, 0.25f * 4095.0f);
+	alignas(16) int32 indices[4];
+	_mm_store_si128(reinterpret_cast<__m128i *>(indices), _mm_cvtps_epi32(_mm_mul_ps(sum, scale)));
+
+	out[0] = tables.from_linear[indices[0]];
+	out[1] = tables.from_linear[indices[1]];
+	out[2] = tables.from_linear[indices[2]];
+	out[3] = static_cast<uint8>(indices[3]);
+#else
+	for (uint32 channel = 0; channel < 3; ++channel) {
+		real32 sum = tables.to_linear[a[channel]] + tables.to_linear[b[channel]] + tables.to_linear[c[channel]] + tables.to_linear[d[channel]];
+		out[channel] = tables.from_linear[static_cast<uint32>(sum * 0.25f * 4095.0f + 0.5f)];
+	}
+	out[3] = static_cast<uint8>((a[3] + b[3] + c[3] + d[3] + 2) / 4);
+#endif
+}
+
+internal_function void average_unorm(const uint8 *a, const uint8 *b, const uint8 *c, const uint8 *d, uint8 *out) {
+#if MIPMAPS_SSE2
+	// widened to 16 bit, four texels can't overflow
+	__m128i zero = _mm_setzero_si128();
+	int32 texels[4];
+	memcpy(&texels[0], a, 4);
+	memcpy(&texels[1], b, 4);
+	memcpy(&texels[2], c, 4);
+	memcpy(&texels[3], d, 4);
+	__m128i sum = _mm_unpacklo_epi8(_mm_cvtsi32_si128(texels[0]), zero);
+	sum = _mm_add_epi16(sum, _mm_unpacklo_epi8(_mm_cvtsi32_si128(texels[1]), zero));
+	sum = _mm_add_epi16(sum, _mm_unpacklo_epi8(_mm_cvtsi32_si128(texels[2]), zero));
+	sum = _mm_add_epi16(sum, _mm_unpacklo_epi8(_mm_cvtsi32_si128(texels[3]), zero));
+	sum = _mm_srli_epi16(_mm_add_epi16(sum, _mm_set1_epi16(2)), 2);
+
+	int32 result = _mm_cvtsi128_si32(_mm_packus_epi16(sum, zero));
+	memcpy(out, &result, 4);
+#else
+	for (uint32 channel = 0; channel < 4; ++channel) {
+		out[channel] = static_cast<uint8>((a[channel] + b[channel] + c[channel] + d[channel] + 2) / 4);
+	}
+#endif
+}
+
+internal_function void downsample(const uint8 *source, uint32 source_width, uint32 source_height, uint8 *destination, uint32 width, uint32 height, bool srgb) {
+	const Srgb_Tables &tables = get_srgb_tables();
+
+	for (uint32 y = 0; y < height; ++y) {
+		// odd sizes: the last texel of a row or column counts twice
+		uint32 y0 = 2 * y < source_height ? 2 * y : source_height - 1;
+		uint32 y1 = 2 * y + 1 < source_height ? 2 * y + 1 : source_height - 1;
+		const uint8 *row0 = source + static_cast<size_t>(y0) * source_width * 4;
+		const uint8 *row1 = source + static_cast<size_t>(y1) * source_width * 4;
+		uint8 *out = destination + static_cast<size_t>(y) * width * 4;
+
+		for (uint32 x = 0; x < width; ++x) {
+			uint32 x0 = 2 * x < source_width ? 2 * x : source_width - 1;
+			uint32 x1 = 2 * x + 1 < source_width ? 2 * x + 1 : source_width - 1;
+			if (srgb) {
+				average_srgb(tables, row0 + x0 * 4, row0 + x1 * 4, row1 + x0 * 4, row1 + x1 * 4, out + x * 4);
+			}
+			else {
+				average_unorm(row0 + x0 * 4, row0 + x1 * 4, row1 + x0 * 4, row1 + x1 * 4, out + x * 4);
+			}
+		}
+	}
+}
+
+//
+// Exported
+//
+
+uint32 get_mip_level_count(uint32 width, uint32 height) {
+	uint32 largest = width > height ? width : height;
+	uint32 level_count = 1;
+	while (largest > 1) {
+		largest /= 2;
+		++level_count;
+	}
+	return level_count;
+}
+
+size_t get_mip_chain_size(uint32 width, uint32 height, uint32 layer_count, uint32 level_count) {
+	size_t size = 0;
+	for (uint32 level = 0; level < level_count; ++level) {
+		size += static_cast<size_t>(width) * height * 4 * layer_count;
+		width = width > 1 ? width / 2 : 1;
+		height = height > 1 ? height / 2 : 1;
+	}
+	return size;
+}
+
+void generate_mip_chain(uint8 *chain, uint32 width, uint32 height, uint32 layer_count, uint32 level_count, bool srgb) {
+	uint8 *source = chain;
+	for (uint32 level = 1; level < level_count; ++level) {
+		uint32 level_width = width > 1 ? width / 2 : 1;
+		uint32 level_height = height > 1 ? height / 2 : 1;
+
+		size_t source_layer_size = static_cast<size_t>(width) * height * 4;
+		size_t layer_size = static_cast<size_t>(level_width) * level_height * 4;
+		uint8 *destination = source + source_layer_size * layer_count;
+		for (uint32 layer = 0; layer < layer_count; ++layer) {
+			downsample(source + layer * source_layer_size, width, height, destination + layer * layer_size, level_width, level_height, srgb);
+		}
+
+		source = destination;
+		width = level_width;
+		height = level_height;
+	}
+}
@@ -0,0 +1,22 @@
+#ifndef MIPMAPS_H
+#define MIPMAPS_H
+
+#include "types.hpp"
+
+#include <stddef.h>
+
+// NOTE: mip chains are built on the cpu when a texture is created, so the upload stays plain buffer to image
+// copies the transfer queue can do (blits need a graphics queue). Every level is a 2x2 box filter of the one above
+// (edge texels repeat for odd sizes), sRGB texels are averaged in linear space. SSE2 where the compiler has it.
+//
+// A chain is stored level after level, every level holds all layers back to back; that is the order
+// upload_image copies it in.
+
+// down to 1x1
+uint32 get_mip_level_count(uint32 width, uint32 height);
+// bytes of RGBA8 texels in the whole chain
+size_t get_mip_chain_size(uint32 width, uint32 height, uint32 layer_count, uint32 level_count);
+// level 0 has to be filled in already, the rest of the chain gets written after it
+void generate_mip_chain(uint8 *chain, uint32 width, uint32 height, uint32 layer_count, uint32 level_count, bool srgb);
+
+#endif
@@ -25,6 +25,9 @@ void platform_error_message_window(const char *title, const char *message);
 uint32 platform_get_file_size(const char *file_path);
 uint32 platform_read_file(const char *file_path, File_Asset *file_asset);
 void platform_free_file(File_Asset *file_asset);
+bool platform_write_file(const char *file_path, const void *data, uint32 size);
+// calls callback with the name of every file directly in directory (no sub directories, no recursion)
+bool platform_list_directory(const char *directory, void (*callback)(const char *file_name, void *user_data), void *user_data);
 
 void platform_logging_init();
 void platform_logging_free();
@@ -1,13 +1,305 @@
+#include "platform.hpp"
+
 #include "types.hpp"
+#include "game.hpp"
+#include "renderer.hpp"
+#include "jobs.hpp"
+#include "atlas.hpp"
+#include "texture_compression.hpp"
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <dirent.h>
+#include <sys/stat.h>
+
+// NOTE: there is no window on linux (yet), the game runs headless: a fixed number of frames is rendered into
+// offscreen images and the last one can be written out. That is what benchmarks and image regression tests on
+// display-less CI machines need; it also runs without a gpu on lavapipe.
+//
+// usage: game [-width N] [-height N] [-frames N] [-out file.ppm] [-frames_in_flight N]
+//        game -cook_atlas sprite_directory file.atlas (packs the pngs offline and exits, no gpu needed)
+//        game -cook_texture image file.tex rgba8|bc1|bc3|bc7 (encodes the image and its mip chain and exits)
+
+constexpr uint DEFAULT_WIDTH = 1440;
+constexpr uint DEFAULT_HEIGHT = 810;
+constexpr uint DEFAULT_FRAME_COUNT = 100;
+constexpr uint MAX_DIMENSION = 16384; // maxImageDimension2D of the biggest gpus
+constexpr uint MAX_FRAME_COUNT = 1000000;
+constexpr real32 HEADLESS_DELTA_TIME = 1.0f / 60.0f; // fixed and no timing hud, so every run renders exactly the same frames
+
+global_variable Window_Dimensions window_dimensions = { DEFAULT_WIDTH, DEFAULT_HEIGHT };
+
+// the whole string has to be a number in [1, max], anything else is logged and leaves value as it is
+internal_function void parse_uint_argument(const char *name, const char *text, uint max, uint *value) {
+	char *end = 0;
+	errno = 0;
+	unsigned long parsed = strtoul(text, &end, 10);
+	if (end == text || *end != '\0' || errno == ERANGE || text[0] == '-' || parsed == 0 || parsed > max) {
+		platform_log("Warning: Invalid value %s for %s, it has to be between 1 and %u! Keeping %u.\n", text, name, max, *value);
+		return;
+	}
+	*value = (uint)parsed;
+}
+
+internal_function uint64 get_time_ns() {
+	timespec time = {};
+	clock_gettime(CLOCK_MONOTONIC, &time);
+	return (uint64)time.tv_sec * 1000000000ull + (uint64)time.tv_nsec;
+}
+
+// binary ppm, the simplest format any image diffing tool reads
+internal_function bool write_ppm(const char *file_path, const uint8 *rgba, uint32 width, uint32 height) {
+	char header[64];
+	int header_size = snprintf(header, sizeof(header), "P6\n%u %u\n255\n", width, height);
+
+	uint32 pixel_count = width * height;
+	uint32 size = (uint32)header_size + pixel_count * 3;
+	uint8 *data = new uint8[size];
+	memcpy(data, header, header_size);
+
+	uint8 *rgb = data + header_size;
+	for (uint32 i = 0; i < pixel_count; ++i) {
+		rgb[i * 3 + 0] = rgba[i * 4 + 0];
+		rgb[i * 3 + 1] = rgba[i * 4 + 1];
+		rgb[i * 3 + 2] = rgba[i * 4 + 2];
+	}
+
+	bool result = platform_write_file(file_path, data, size);
+	delete[] data;
+	return result;
+}
+
+void *platform_get_window_handles() {
+	return 0;
+}
+
+void platform_get_window_dimensions(Window_Dimensions *dimensions) {
+	dimensions->width = window_dimensions.width;
+	dimensions->height = window_dimensions.height;
+}
+
+// headless runs have no audio device to play on, the sound is dropped
+bool platform_audio_play_file(const char *) {
+	local_persist bool logged = false;
+	if (!logged) {
+		platform_log("Warning: Audio is not supported when running headless, sounds are not played!\n");
+		logged = true;
+	}
+	return false;
+}
+
+void platform_log(const char *message, ...) {
+	va_list arg_ptr;
+	va_start(arg_ptr, message);
+	vfprintf(stdout, message, arg_ptr);
+	va_end(arg_ptr);
+}
+
+void platform_error_message_window(const char *title, const char *message) {
+	fprintf(stderr, "%s %s\n", title, message);
+}
+
+void platform_logging_init() {
+}
+
+void platform_logging_free() {
+	fflush(stdout);
+}
+
+uint32 platform_get_file_size(const char *file_path) {
+	FILE *file = fopen(file_path, "rb");
+	if (!file) return 0;
+
+	fseek(file, 0, SEEK_END);
+	long size = ftell(file);
+	fclose(file);
+	if (size < 0) return 0;
+
+	return (uint32)size;
+}
+
+uint32 platform_read_file(const char *file_path, File_Asset *file_asset) {
+	FILE *file = fopen(file_path, "rb");
+	if (!file) return 0;
+
+	fseek(file, 0, SEEK_END);
+	long size = ftell(file);
+	fseek(file, 0, SEEK_SET);
+	if (size <= 0) {
+		fclose(file);
+		return 0;
+	}
+
+	file_asset->data = new char[size];
+	file_asset->size = (uint32)size;
+
+	size_t number_of_bytes_read = fread(file_asset->data, 1, size, file);
+	fclose(file);
+	if (number_of_bytes_read != (size_t)size) {
+		platform_free_file(file_asset);
+		return 0;
+	}
+
+	return (uint32)number_of_bytes_read;
+}
+
+void platform_free_file(File_Asset *file_asset) {
+	delete[] file_asset->data;
+	file_asset->data = NULL;
+	file_asset->size = 0;
+}
+
+bool platform_write_file(const char *file_path, const void *data, uint32 size) {
+	// write into a temporary file first, that way a crash mid write never leaves a truncated file behind
+	char temp_path[4096];
+	int length = snprintf(temp_path, sizeof(temp_path), "%s.tmp", file_path);
+	if (length < 0 || length >= (int)sizeof(temp_path)) return false;
+
+	FILE *file = fopen(temp_path, "wb");
+	if (!file) return false;
+
+	size_t number_of_bytes_written = fwrite(data, 1, size, file);
+	bool closed = fclose(file) == 0;
+	if (number_of_bytes_written != size || !closed) {
+		remove(temp_path);
+		return false;
+	}
+
+	if (rename(temp_path, file_path) != 0) {
+		remove(temp_path);
+		return false;
+	}
+
+	return true;
+}
+
+bool platform_list_directory(const char *directory, void (*callback)(const char *file_name, void *user_data), void *user_data) {
+	DIR *dir = opendir(directory);
+	if (!dir) return false;
+
+	char path[4096];
+	for (dirent *entry = readdir(dir); entry; entry = readdir(dir)) {
+		// d_type is DT_UNKNOWN on some file systems, stat knows for sure
+		int length = snprintf(path, sizeof(path), "%s/%s", directory, entry->d_name);
+		if (length < 0 || length >= (int)sizeof(path)) continue;
+
+		struct stat file_stat;
+		if (stat(path, &file_stat) != 0 || !S_ISREG(file_stat.st_mode)) continue;
+
+		callback(entry->d_name, user_data);
+	}
+
+	closedir(dir);
+	return true;
+}
+
+int main(int argc, char **argv) {
+	platform_logging_init();
+
+	uint frame_count = DEFAULT_FRAME_COUNT;
+	const char *out_path = 0;
+	Renderer_Settings renderer_settings = DEFAULT_RENDERER_SETTINGS;
+	for (int i = 1; i < argc; ++i) {
+		bool has_value = i + 1 < argc;
+		if (renderer_parse_argument(argv[i], has_value ? argv[i + 1] : 0, &renderer_settings)) {
+			++i;
+		}
+		else if (strcmp(argv[i], "-width") == 0 && has_value) {
+			parse_uint_argument(argv[i], argv[i + 1], MAX_DIMENSION, &window_dimensions.width);
+			++i;
+		}
+		else if (strcmp(argv[i], "-height") == 0 && has_value) {
+			parse_uint_argument(argv[i], argv[i + 1], MAX_DIMENSION, &window_dimensions.height);
+			++i;
+		}
+		else if (strcmp(argv[i], "-frames") == 0 && has_value) {
+			parse_uint_argument(argv[i], argv[i + 1], MAX_FRAME_COUNT, &frame_count);
+			++i;
+		}
+		else if (strcmp(argv[i], "-out") == 0 && has_value) {
+			out_path = argv[++i];
+		}
+		else if (strcmp(argv[i], "-cook_atlas") == 0 && i + 2 < argc) {
+			bool cooked = cook_sprite_atlas(argv[i + 1], argv[i + 2]);
+			platform_logging_free();
+			return cooked ? GAME_SUCCESS : GAME_FAILURE;
+		}
+		else if (strcmp(argv[i], "-cook_texture") == 0 && i + 3 < argc) {
+			Texture_Encoding encoding;
+			bool cooked = parse_texture_encoding(argv[i + 3], &encoding);
+			if (!cooked) {
+				platform_log("Unknown texture encoding %s!\n", argv[i + 3]);
+			}
+			cooked = cooked && cook_texture(argv[i + 1], argv[i + 2], encoding);
+			platform_logging_free();
+			return cooked ? GAME_SUCCESS : GAME_FAILURE;
+		}
+		else {
+			platform_log("Warning: Unknown argument %s!\n", argv[i]);
+		}
+	}
+
+	jobs_init();
+
+	Headless_Settings headless_settings = {
+		.width = window_dimensions.width,
+		.height = window_dimensions.height,
+		.read_back = out_path != 0,
+	};
+	bool32 result = renderer_vulkan_init_headless(headless_settings, renderer_settings);
+	if (result != GAME_SUCCESS) {
+		platform_log("Fatal: Failed to initialize vulkan!\n");
+		jobs_shutdown();
+		platform_logging_free();
+		return GAME_FAILURE;
+	}
+
+	Game_State game_state = { /* should close */ false, /* Mode */ MODE_PLAY, /* Player {Position, Speed}*/ {{0.0f, 0.0f}, 5.0f}, /* Camera {Position, Half Height} */ {{0.0f, 0.0f}, 3.0f}};
+
+	uint64 start_time = get_time_ns();
+	uint64 last_time = start_time;
+	for (uint frame = 0; frame < frame_count && !game_state.should_close; ++frame) {
+		//
+		// Game Update and Render
+		//
+		game_update(&game_state, HEADLESS_DELTA_TIME);
+		game_render(&game_state);
+
+		//
+		// calculating performance metrics
+		//
+		uint64 end_time = get_time_ns();
+		perf_metrics.ms_per_frame = (real64)(end_time - last_time) / 1000000.0;
+		perf_metrics.fps = 1000.0 / perf_metrics.ms_per_frame;
+		last_time = end_time;
+	}
+
+	renderer_vulkan_wait_idle();
+	uint64 total_time = get_time_ns() - start_time;
+	if (frame_count > 0) {
+		platform_log("Rendered %u frames in %.2f ms (%.3f ms per frame)\n", frame_count, (real64)total_time / 1000000.0, (real64)total_time / 1000000.0 / frame_count);
+	}
+
+	int exit_code = 0;
+	if (out_path) {
+		uint32 width = 0;
+		uint32 height = 0;
+		const uint8 *pixels = renderer_read_back_last_frame(&width, &height);
+		if (!pixels || !write_ppm(out_path, pixels, width, height)) {
+			platform_log("Fatal: Failed to write the last frame to %s!\n", out_path);
+			exit_code = GAME_FAILURE;
+		}
+	}
 
-struct PlatformWindow
-{
-	// some linux window handle
-	int width;
-	int height;
-};
+	// cleanup
+	renderer_vulkan_cleanup();
+	jobs_shutdown();
 
-void platform_create_window(const char *title, int width, int height)
-{
+	platform_logging_free();
 
-}
\ No newline at end of file
+	return exit_code;
+}
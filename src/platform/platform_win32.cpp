@@ -4,10 +4,14 @@
 #include "input.hpp"
 #include "game.hpp"
 #include "renderer.hpp"
+#include "jobs.hpp"
 
 #include <windows.h>
 #include <xaudio2.h>
 
+#include <stdio.h>
+#include <stdlib.h> // __argc, __argv
+
 struct Win32WindowHandles {
 	HINSTANCE hinstance;
 	HWND hwnd;
@@ -40,11 +44,13 @@ public:
 
 constexpr uint WIDTH = 1440;
 constexpr uint HEIGHT = 810;
+constexpr UINT_PTR RESIZE_TIMER_ID = 1;
 
 global_variable bool should_close = true;
 global_variable Win32_Audio_Device audio_device = {};
 global_variable Win32WindowHandles window_handles = {};
 global_variable Window_Dimensions window_dimensions = { WIDTH, HEIGHT };
+global_variable Game_State *running_game_state = 0; // so frames can be rendered from inside the window callback
 
 // big endian
 #ifdef _XBOX
@@ -248,13 +254,25 @@ LRESULT CALLBACK main_window_callback(HWND w_handle, UINT message, WPARAM wparam
 
 	switch (message) {
 		case WM_SIZE: {
+			// NOTE: only the size is stored, the renderer picks it up once per frame, so a burst of these during a
+			// resize ends up as a single swapchain recreation
 			window_dimensions = { LOWORD(lparam), HIWORD(lparam) };
-			//static int i = 0;
-			//if (i > 0)
-			//{
-			//	if (wparam == SIZE_RESTORED) game_render(&game_state);
-			//}
-			//++i;
+		} break;
+
+		// while the window is dragged or resized Windows runs its own message loop and the main loop stalls, a
+		// timer keeps frames coming in the meantime
+		case WM_ENTERSIZEMOVE: {
+			SetTimer(w_handle, RESIZE_TIMER_ID, USER_TIMER_MINIMUM, 0);
+		} break;
+
+		case WM_EXITSIZEMOVE: {
+			KillTimer(w_handle, RESIZE_TIMER_ID);
+		} break;
+
+		case WM_TIMER: {
+			if (wparam == RESIZE_TIMER_ID && running_game_state) {
+				game_render(running_game_state);
+			}
 		} break;
 
 		case WM_CLOSE: {
@@ -459,6 +477,49 @@ void platform_free_file(File_Asset *file_asset) {
 	file_asset->size = 0;
 }
 
+bool platform_write_file(const char *file_path, const void *data, uint32 size) {
+	// write into a temporary file first, that way a crash mid write never leaves a truncated file behind
+	char temp_path[MAX_PATH];
+	int length = snprintf(temp_path, sizeof(temp_path), "%s.tmp", file_path);
+	if (length < 0 || length >= (int)sizeof(temp_path)) return false;
+
+	HANDLE file_handle = CreateFileA(temp_path, GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (file_handle == INVALID_HANDLE_VALUE) return false;
+
+	DWORD number_of_bytes_written = 0;
+	BOOL written = WriteFile(file_handle, data, size, &number_of_bytes_written, NULL);
+	CloseHandle(file_handle);
+	if (!written || number_of_bytes_written != size) {
+		DeleteFileA(temp_path);
+		return false;
+	}
+
+	if (!MoveFileExA(temp_path, file_path, MOVEFILE_REPLACE_EXISTING)) {
+		DeleteFileA(temp_path);
+		return false;
+	}
+
+	return true;
+}
+
+bool platform_list_directory(const char *directory, void (*callback)(const char *file_name, void *user_data), void *user_data) {
+	char pattern[MAX_PATH];
+	int length = snprintf(pattern, sizeof(pattern), "%s\\*", directory);
+	if (length < 0 || length >= (int)sizeof(pattern)) return false;
+
+	WIN32_FIND_DATAA find_data;
+	HANDLE find_handle = FindFirstFileA(pattern, &find_data);
+	if (find_handle == INVALID_HANDLE_VALUE) return false;
+
+	do {
+		if (find_data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) continue;
+		callback(find_data.cFileName, user_data);
+	} while (FindNextFileA(find_handle, &find_data));
+
+	FindClose(find_handle);
+	return true;
+}
+
 int CALLBACK WinMain(_In_ HINSTANCE h_instance, _In_opt_ HINSTANCE h_prev_instance, _In_ PSTR cmd_line, _In_ int cmdshow) {
 #ifdef _DEBUG
 	platform_logging_init();
@@ -487,16 +548,31 @@ int CALLBACK WinMain(_In_ HINSTANCE h_instance, _In_opt_ HINSTANCE h_prev_instan
 		return result;
 	}
 
-	result = renderer_vulkan_init();
+	// usage: game [-frames_in_flight N] [-swapchain_images N] [-present fifo|fifo_relaxed|mailbox|immediate]
+	Renderer_Settings renderer_settings = DEFAULT_RENDERER_SETTINGS;
+	for (int i = 1; i < __argc; ++i) {
+		const char *value = i + 1 < __argc ? __argv[i + 1] : 0;
+		if (renderer_parse_argument(__argv[i], value, &renderer_settings)) {
+			++i;
+		}
+		else {
+			platform_log("Warning: Unknown argument %s!\n", __argv[i]);
+		}
+	}
+
+	jobs_init();
+
+	result = renderer_vulkan_init(renderer_settings);
 	if (result != GAME_SUCCESS) {
 		platform_log("Fatal: Failed to initialize vulkan!\n");
 		__debugbreak();
 		return GAME_FAILURE;
 	}
 
-	Game_State game_state = { /* should close */ false, /* Mode */ MODE_PLAY, /* Player {Position, Speed}*/ {{0.0f, 0.0f}, 5.0f}};
+	Game_State game_state = { /* should close */ false, /* Mode */ MODE_PLAY, /* Player {Position, Speed}*/ {{0.0f, 0.0f}, 5.0f}, /* Camera {Position, Half Height} */ {{0.0f, 0.0f}, 3.0f}};
 
 	should_close = false;
+	running_game_state = &game_state;
 
 	LARGE_INTEGER last_counter;
 	QueryPerformanceCounter(&last_counter);
@@ -533,11 +609,14 @@ int CALLBACK WinMain(_In_ HINSTANCE h_instance, _In_opt_ HINSTANCE h_prev_instan
 		last_cycle_count = end_cycle_count;
 	}
 	
+	running_game_state = 0;
+
 	// don't crash on closing the application; not needed if we skip cleanup since we can't crash if we're not even trying to clean up the device
-	//renderer_vulkan_wait_idle();
+	renderer_vulkan_wait_idle();
 
 	// cleanup
-	//renderer_vulkan_cleanup();
+	renderer_vulkan_cleanup();
+	jobs_shutdown();
 	//platform_destroy_sound_device(&audio_device);
 	//platform_destroy_window();
 
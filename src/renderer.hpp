@@ -3,10 +3,48 @@
 
 #include "game.hpp"
 
-bool32 renderer_vulkan_init();
+// NOTE: picked at startup (command line), so latency and throughput configurations don't need a rebuild. One frame
+// in flight has the least input latency, more let the cpu record ahead while the gpu works.
+enum Present_Mode {
+	PRESENT_MODE_FIFO         = 0, // vsync, always supported
+	PRESENT_MODE_FIFO_RELAXED = 1, // vsync, but late frames tear instead of waiting another interval
+	PRESENT_MODE_MAILBOX      = 2, // no tearing, the newest frame replaces a waiting one
+	PRESENT_MODE_IMMEDIATE    = 3, // no vsync, tears
+};
+
+struct Renderer_Settings {
+	uint32 frames_in_flight;      // 1 to 3
+	uint32 swapchain_image_count; // 0 lets the surface's minimum + 1 decide, otherwise clamped to what it supports
+	Present_Mode present_mode;    // falls back to FIFO if the surface doesn't support it
+};
+
+constexpr Renderer_Settings DEFAULT_RENDERER_SETTINGS = {
+	.frames_in_flight = 2,
+	.swapchain_image_count = 0,
+	.present_mode = PRESENT_MODE_MAILBOX,
+};
+
+// NOTE: headless rendering needs neither a window nor a gpu (lavapipe works), it's meant for benchmarks and
+// image regression tests on machines without a display
+struct Headless_Settings {
+	uint32 width;
+	uint32 height;
+	bool read_back; // copy every frame back to host memory
+};
+
+// -frames_in_flight N, -swapchain_images N, -present fifo|fifo_relaxed|mailbox|immediate. value is the argument
+// after it (or 0), returns true if both were used, the caller skips value then.
+bool renderer_parse_argument(const char *argument, const char *value, Renderer_Settings *settings);
+
+bool32 renderer_vulkan_init(const Renderer_Settings &settings);
+bool32 renderer_vulkan_init_headless(const Headless_Settings &headless, const Renderer_Settings &settings);
 void renderer_vulkan_cleanup();
 void renderer_vulkan_wait_idle();
 
+// headless with read back only: waits for the last rendered frame and returns its pixels (tightly packed RGBA8
+// rows, sRGB), 0 otherwise; the pointer is valid until the next game_render
+const uint8 *renderer_read_back_last_frame(uint32 *width, uint32 *height);
+
 void game_render(Game_State *game_state);
 
 #endif
@@ -0,0 +1,213 @@
+#include "bindless.hpp"
+
+#include "platform.hpp"
+#include "renderer/vulkan_init.hpp"
+#include "renderer/samplers.hpp"
+
+#include <vulkan/vulkan.h>
+
+#include <vector>
+
+//
+// Internal
+//
+
+struct Bindless_Textures {
+	VkDescriptorPool pool;
+	VkDescriptorSet set;
+	uint32 capacity;
+	uint32 count; // high water mark, slots below it are either used or on the free list
+	std::vector<uint32> free_indices;
+};
+
+global_variable Bindless_Textures bindless = {};
+
+internal_function uint32 get_bindless_capacity() {
+	VkPhysicalDeviceVulkan12Properties vulkan12_properties = {
+		.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_PROPERTIES,
+	};
+	VkPhysicalDeviceProperties2 properties2 = {
+		.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2,
+		.pNext = &vulkan12_properties,
+	};
+	vkGetPhysicalDeviceProperties2(c.physical_device, &properties2);
+
+	// the samplers are separate, so only sampled images count against the limits
+	uint32 capacity = MAX_BINDLESS_TEXTURES;
+	uint32 limits[] = {
+		vulkan12_properties.maxPerStageDescriptorUpdateAfterBindSampledImages,
+		vulkan12_properties.maxDescriptorSetUpdateAfterBindSampledImages,
+	};
+	for (uint32 limit : limits) {
+		if (limit < capacity) capacity = limit;
+	}
+	return capacity;
+}
+
+//
+// Exported
+//
+
+bool bindless_supported(VkPhysicalDevice physical_device) {
+	VkPhysicalDeviceProperties properties;
+	vkGetPhysicalDeviceProperties(physical_device, &properties);
+	if (properties.apiVersion < VK_API_VERSION_1_2) return false;
+
+	VkPhysicalDeviceVulkan12Features vulkan12_features = {
+		.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES,
+	};
+	VkPhysicalDeviceFeatures2 features2 = {
+		.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2,
+		.pNext = &vulkan12_features,
+	};
+	vkGetPhysicalDeviceFeatures2(physical_device, &features2);
+
+	return vulkan12_features.descriptorIndexing &&
+		vulkan12_features.runtimeDescriptorArray &&
+		vulkan12_features.descriptorBindingPartiallyBound &&
+		vulkan12_features.descriptorBindingSampledImageUpdateAfterBind &&
+		vulkan12_features.descriptorBindingUpdateUnusedWhilePending &&
+		vulkan12_features.shaderSampledImageArrayNonUniformIndexing;
+}
+
+bool bindless_init() {
+	bindless.capacity = get_bindless_capacity();
+
+	//
+	// layout
+	//
+	{
+		VkDescriptorSetLayoutBinding bindings[] = {
+			{
+				.binding = 0,
+				.descriptorType = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE,
+				.descriptorCount = bindless.capacity,
+				.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT,
+			},
+			{
+				// baked into the layout, they are never written and the set has nothing to update for them
+				.binding = 1,
+				.descriptorType = VK_DESCRIPTOR_TYPE_SAMPLER,
+				.descriptorCount = SAMPLER_COUNT,
+				.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT,
+				.pImmutableSamplers = get_immutable_samplers(),
+			},
+		};
+
+		VkDescriptorBindingFlags binding_flags[] = {
+			VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT | VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT | VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT,
+			0,
+		};
+		VkDescriptorSetLayoutBindingFlagsCreateInfo binding_flags_info = {
+			.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO,
+			.bindingCount = sizeof(binding_flags) / sizeof(binding_flags[0]),
+			.pBindingFlags = binding_flags,
+		};
+
+		VkDescriptorSetLayoutCreateInfo layout_info = {
+			.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+			.pNext = &binding_flags_info,
+			.flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT,
+			.bindingCount = sizeof(bindings) / sizeof(bindings[0]),
+			.pBindings = bindings,
+		};
+
+		VkResult result = vkCreateDescriptorSetLayout(c.device, &layout_info, 0, &c.bindless_set_layout);
+		if (result != VK_SUCCESS) {
+			platform_log("Fatal: Failed to create the bindless descriptor set layout!\n");
+			return false;
+		}
+	}
+
+	//
+	// pool and the one set everything uses
+	//
+	{
+		VkDescriptorPoolSize pool_sizes[] = {
+			{ .type = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, .descriptorCount = bindless.capacity },
+			{ .type = VK_DESCRIPTOR_TYPE_SAMPLER, .descriptorCount = SAMPLER_COUNT },
+		};
+
+		VkDescriptorPoolCreateInfo pool_info = {
+			.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+			.flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT,
+			.maxSets = 1,
+			.poolSizeCount = sizeof(pool_sizes) / sizeof(pool_sizes[0]),
+			.pPoolSizes = pool_sizes,
+		};
+
+		VkResult result = vkCreateDescriptorPool(c.device, &pool_info, 0, &bindless.pool);
+		if (result != VK_SUCCESS) {
+			platform_log("Fatal: Failed to create the bindless descriptor pool!\n");
+			return false;
+		}
+
+		VkDescriptorSetAllocateInfo alloc_info = {
+			.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+			.descriptorPool = bindless.pool,
+			.descriptorSetCount = 1,
+			.pSetLayouts = &c.bindless_set_layout,
+		};
+
+		result = vkAllocateDescriptorSets(c.device, &alloc_info, &bindless.set);
+		if (result != VK_SUCCESS) {
+			platform_log("Fatal: Failed to allocate the bindless descriptor set!\n");
+			return false;
+		}
+	}
+
+	platform_log("Bindless textures: %u descriptors\n", bindless.capacity);
+
+	return true;
+}
+
+void bindless_shutdown() {
+	vkDestroyDescriptorPool(c.device, bindless.pool, 0);
+	vkDestroyDescriptorSetLayout(c.device, c.bindless_set_layout, 0);
+	c.bindless_set_layout = VK_NULL_HANDLE;
+	bindless = {};
+}
+
+uint32 bindless_register_texture(VkImageView image_view) {
+	uint32 descriptor_index;
+	if (!bindless.free_indices.empty()) {
+		descriptor_index = bindless.free_indices.back();
+		bindless.free_indices.pop_back();
+	}
+	else if (bindless.count < bindless.capacity) {
+		descriptor_index = bindless.count++;
+	}
+	else {
+		platform_log("Fatal: Ran out of bindless texture descriptors!\n");
+		return INVALID_DESCRIPTOR_INDEX;
+	}
+
+	VkDescriptorImageInfo image_info = {
+		.imageView = image_view,
+		.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+	};
+
+	VkWriteDescriptorSet descriptor_write = {
+		.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+		.dstSet = bindless.set,
+		.dstBinding = 0,
+		.dstArrayElement = descriptor_index,
+		.descriptorCount = 1,
+		.descriptorType = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE,
+		.pImageInfo = &image_info,
+	};
+	vkUpdateDescriptorSets(c.device, 1, &descriptor_write, 0, 0);
+
+	return descriptor_index;
+}
+
+void bindless_unregister_texture(uint32 descriptor_index) {
+	// NOTE: the slot is partially bound, so it doesn't need to be rewritten; the caller has to make sure no
+	// frame in flight still samples it before the index is handed out again
+	if (descriptor_index == INVALID_DESCRIPTOR_INDEX) return;
+	bindless.free_indices.push_back(descriptor_index);
+}
+
+void bind_bindless_textures(VkCommandBuffer command_buffer, VkPipelineLayout pipeline_layout) {
+	vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline_layout, BINDLESS_TEXTURE_SET, 1, &bindless.set, 0, 0);
+}
@@ -0,0 +1,26 @@
+#ifndef BINDLESS_H
+#define BINDLESS_H
+
+#include "types.hpp"
+
+#include <vulkan/vulkan.h>
+
+// NOTE: every texture lives in one big, partially bound, update-after-bind descriptor array (set 1, binding 0).
+// Shaders index it with the texture's descriptor index, so textures can be added or removed at any time
+// without touching descriptor sets that are bound or in flight, and a frame binds the set exactly once.
+// Binding 1 holds the immutable samplers (samplers.hpp), shaders pair a texture with one of them by index.
+constexpr uint32 BINDLESS_TEXTURE_SET = 1;
+constexpr uint32 MAX_BINDLESS_TEXTURES = 16 * 1024; // clamped to the device limits at init
+constexpr uint32 INVALID_DESCRIPTOR_INDEX = 0xFFFFFFFF;
+
+bool bindless_supported(VkPhysicalDevice physical_device);
+
+bool bindless_init();
+void bindless_shutdown();
+
+uint32 bindless_register_texture(VkImageView image_view);
+void bindless_unregister_texture(uint32 descriptor_index);
+
+void bind_bindless_textures(VkCommandBuffer command_buffer, VkPipelineLayout pipeline_layout);
+
+#endif
@@ -0,0 +1,146 @@
+#include "deletion_queue.hpp"
+
+#include "renderer/vulkan_init.hpp"
+#include "renderer/vulkan_memory.hpp"
+#include "renderer/bindless.hpp"
+#include "renderer/geometry.hpp"
+
+#include <vulkan/vulkan.h>
+
+#include <deque>
+
+//
+// Internal
+//
+
+enum Deletion_Kind {
+	DELETION_BUFFER     = 0,
+	DELETION_IMAGE      = 1,
+	DELETION_IMAGE_VIEW = 2,
+	DELETION_SWAPCHAIN  = 3,
+	DELETION_DESCRIPTOR = 4,
+	DELETION_MESH       = 5,
+};
+
+struct Deferred_Deletion {
+	Deletion_Kind kind;
+	uint64 frame_number;
+	union {
+		VkBuffer buffer;
+		VkImage image;
+		VkImageView image_view;
+		VkSwapchainKHR swapchain;
+		uint32 descriptor_index;
+		Mesh mesh;
+	};
+	Memory_Allocation memory; // buffers and images
+};
+
+// queued in frame order, so collecting can stop at the first entry that is still too young
+global_variable std::deque<Deferred_Deletion> deletion_queue;
+
+internal_function void defer(Deferred_Deletion deletion) {
+	deletion.frame_number = c.frame_number;
+	deletion_queue.push_back(deletion);
+}
+
+internal_function void destroy(Deferred_Deletion *deletion) {
+	switch (deletion->kind) {
+		case DELETION_BUFFER: {
+			vkDestroyBuffer(c.device, deletion->buffer, 0);
+			if (deletion->memory.memory) free_memory(&deletion->memory);
+		} break;
+
+		case DELETION_IMAGE: {
+			vkDestroyImage(c.device, deletion->image, 0);
+			if (deletion->memory.memory) free_memory(&deletion->memory);
+		} break;
+
+		case DELETION_IMAGE_VIEW: {
+			vkDestroyImageView(c.device, deletion->image_view, 0);
+		} break;
+
+		case DELETION_SWAPCHAIN: {
+			vkDestroySwapchainKHR(c.device, deletion->swapchain, 0);
+		} break;
+
+		case DELETION_DESCRIPTOR: {
+			bindless_unregister_texture(deletion->descriptor_index);
+		} break;
+
+		case DELETION_MESH: {
+			free_mesh(deletion->mesh);
+		} break;
+	}
+}
+
+//
+// Exported
+//
+
+void defer_destroy_buffer(VkBuffer buffer, const Memory_Allocation &memory) {
+	if (buffer == VK_NULL_HANDLE) return;
+
+	Deferred_Deletion deletion = { .kind = DELETION_BUFFER };
+	deletion.buffer = buffer;
+	deletion.memory = memory;
+	defer(deletion);
+}
+
+void defer_destroy_image(VkImage image, const Memory_Allocation &memory) {
+	if (image == VK_NULL_HANDLE) return;
+
+	Deferred_Deletion deletion = { .kind = DELETION_IMAGE };
+	deletion.image = image;
+	deletion.memory = memory;
+	defer(deletion);
+}
+
+void defer_destroy_image_view(VkImageView image_view) {
+	if (image_view == VK_NULL_HANDLE) return;
+
+	Deferred_Deletion deletion = { .kind = DELETION_IMAGE_VIEW };
+	deletion.image_view = image_view;
+	defer(deletion);
+}
+
+void defer_destroy_swapchain(VkSwapchainKHR swapchain) {
+	if (swapchain == VK_NULL_HANDLE) return;
+
+	Deferred_Deletion deletion = { .kind = DELETION_SWAPCHAIN };
+	deletion.swapchain = swapchain;
+	defer(deletion);
+}
+
+void defer_unregister_texture(uint32 descriptor_index) {
+	if (descriptor_index == INVALID_DESCRIPTOR_INDEX) return;
+
+	Deferred_Deletion deletion = { .kind = DELETION_DESCRIPTOR };
+	deletion.descriptor_index = descriptor_index;
+	defer(deletion);
+}
+
+void defer_free_mesh(const Mesh &mesh) {
+	if (mesh.index_count == 0 && mesh.vertex_count == 0) return;
+
+	Deferred_Deletion deletion = { .kind = DELETION_MESH };
+	deletion.mesh = mesh;
+	defer(deletion);
+}
+
+void deletion_queue_collect() {
+	while (!deletion_queue.empty()) {
+		Deferred_Deletion &deletion = deletion_queue.front();
+		if (c.frame_number < deletion.frame_number + c.frames_in_flight) break;
+
+		destroy(&deletion);
+		deletion_queue.pop_front();
+	}
+}
+
+void deletion_queue_flush() {
+	for (Deferred_Deletion &deletion : deletion_queue) {
+		destroy(&deletion);
+	}
+	deletion_queue.clear();
+}
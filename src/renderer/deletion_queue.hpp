@@ -0,0 +1,29 @@
+#ifndef DELETION_QUEUE_H
+#define DELETION_QUEUE_H
+
+#include "types.hpp"
+#include "renderer/vulkan_memory.hpp"
+#include "assets.hpp"
+
+#include <vulkan/vulkan.h>
+
+// NOTE: nothing a frame in flight might still use can be destroyed right away. The defer functions queue the
+// object with the current c.frame_number (the last frame that could have used it) and deletion_queue_collect
+// destroys it once that frame's fence has retired, c.frame_number >= frame + c.frames_in_flight. Objects are
+// destroyed in the order they were queued, so queue views before their image and images before their swapchain.
+// Main thread only.
+void defer_destroy_buffer(VkBuffer buffer, const Memory_Allocation &memory);
+void defer_destroy_image(VkImage image, const Memory_Allocation &memory);
+void defer_destroy_image_view(VkImageView image_view);
+void defer_destroy_swapchain(VkSwapchainKHR swapchain);
+// the bindless slot is only handed out again once no frame samples the old texture through it
+void defer_unregister_texture(uint32 descriptor_index);
+// the mesh's vertex and index ranges in the geometry buffer are reused once no frame draws the mesh anymore
+void defer_free_mesh(const Mesh &mesh);
+
+// once per frame, right after the frame's fence was waited on
+void deletion_queue_collect();
+// destroys everything that is queued; only once the device is idle (shutdown)
+void deletion_queue_flush();
+
+#endif
@@ -1,42 +1,560 @@
 #include "fonts.hpp"
 
 #include "platform.hpp"
+#include "assets.hpp"
+#include "hash.hpp"
+#include "renderer/vulkan_init.hpp"
+#include "renderer/vulkan_helper.hpp"
+#include "renderer/deletion_queue.hpp"
 
 #include <lib/stb_truetype.h>
+#include <vulkan/vulkan.h>
 
-#define SIZE(x) sizeof(x) / sizeof(x[0])
+#include <string.h>
+#include <algorithm>
+#include <unordered_map>
+#include <vector>
 
-const char *fonts[] = { "res/fonts/SourceCodePro-Regular.ttf" };
-stbtt_bakedchar cdata[96];
+//
+// Internal
+//
 
-void load_default_fonts() {
-	float font_height = 32.0f; // pixel
-	const int bitmap_w = 512;
-	const int bitmap_h = bitmap_w;
-	unsigned char *temp_bitmap = new unsigned char[bitmap_w * bitmap_h];
+// NOTE: the atlas is a grid of equally sized cells, one glyph each. That wastes some space on narrow glyphs but
+// makes eviction trivial: any free or evicted cell fits any glyph.
+constexpr uint32 GLYPH_ATLAS_SIZE = 1024;
+constexpr uint32 GLYPH_CELL_SIZE = 64;
+constexpr uint32 GLYPH_CELLS_PER_ROW = GLYPH_ATLAS_SIZE / GLYPH_CELL_SIZE;
+constexpr uint32 GLYPH_CELL_COUNT = GLYPH_CELLS_PER_ROW * GLYPH_CELLS_PER_ROW;
+constexpr uint32 NO_GLYPH_CELL = 0xFFFFFFFF;
+constexpr uint32 MAX_GLYPH_UPLOADS_PER_FRAME = 64; // more new glyphs than that show up a frame later
 
-	for (int i = 0; i < SIZE(fonts); ++i) {
-		File_Asset file_asset = {};
-		uint32 bytes_read = platform_read_file(fonts[i], &file_asset);
-		if (bytes_read == 0) { continue; }
+// the distance fields are rasterized at this size, every other size is the same field scaled
+constexpr real32 SDF_PIXEL_HEIGHT = 40.0f;
+constexpr int SDF_PADDING = 6;
+constexpr unsigned char SDF_ON_EDGE = 128; // font.frag has the same edge value
+constexpr real32 SDF_PIXEL_DIST_SCALE = (real32)SDF_ON_EDGE / SDF_PADDING; // falls to 0 at the end of the padding
 
-		int chars_fit = stbtt_BakeFontBitmap(reinterpret_cast<const unsigned char *>(file_asset.data), 0, font_height, temp_bitmap, bitmap_w, bitmap_h, 32, 96, cdata);
-		platform_free_file(&file_asset);
-		if (chars_fit <= 0) {
-			__debugbreak();
+struct Font {
+	const char *file_path;
+	File_Asset file; // info points into it, so it stays loaded
+	stbtt_fontinfo info;
+	real32 sdf_scale;   // font units to atlas pixels
+	real32 ascent;      // atlas pixels from the top of a line to its baseline
+	real32 line_height; // atlas pixels
+};
+
+global_variable Font fonts[FONT_COUNT] = {
+	// FONT_DEFAULT
+	{ .file_path = "res/fonts/SourceCodePro-Regular.ttf" },
+};
+
+// metrics are in atlas pixels, draw_text scales them to the text size
+struct Glyph {
+	uint64 key; // (font << 32) | codepoint
+	int glyph_index;
+	real32 advance;
+	real32 x_offset; // top left of the distance field relative to the pen position on the baseline
+	real32 y_offset;
+	uint32 width;
+	uint32 height;
+	bool empty; // whitespace, nothing to rasterize
+	uint32 cell; // NO_GLYPH_CELL if not in the atlas (yet or anymore)
+};
+
+struct Glyph_Cell {
+	uint64 key; // of the glyph in this cell
+	uint64 last_used_frame;
+	bool used;
+};
+
+struct Glyph_Upload {
+	uint32 cell;
+	VkDeviceSize staging_offset;
+};
+
+struct Glyph_Cache {
+	Texture atlas;
+	VkImageLayout atlas_layout; // undefined until the first upload
+	std::unordered_map<uint64, Glyph> glyphs; // key: (font << 32) | codepoint
+	Glyph_Cell cells[GLYPH_CELL_COUNT];
+	std::vector<uint32> free_cells;
+	uint64 frame; // text_begin_frame calls so far
+	std::vector<Glyph_Upload> uploads; // this frame
+};
+
+global_variable Glyph_Cache glyph_cache;
+
+// NOTE: most text on screen is the same from frame to frame (labels, captions), so laid out strings are cached by
+// a hash of text, font and size. A layout is a run of glyphs relative to the top left of the text, kept in one
+// arena across frames; only the atlas cells and the final positions are looked at again when it is drawn.
+constexpr uint32 MAX_TEXT_LAYOUTS = 1024;
+constexpr uint32 TEXT_LAYOUT_ARENA_GLYPHS = 2 * MAX_GLYPHS_PER_FONT;
+
+struct Laid_Out_Glyph {
+	Glyph *glyph; // glyph_cache never erases, so the pointer stays valid
+	Vec2 offset;  // from the top left of the text, in pixels
+	Vec2 size;    // in pixels
+};
+
+struct Text_Layout {
+	uint64 hash;
+	uint32 first; // into the arena
+	uint32 count;
+	uint64 last_used_frame;
+};
+
+struct Text_Layout_Cache {
+	std::unordered_map<uint64, uint32> lookup; // hash to index into layouts
+	Text_Layout layouts[MAX_TEXT_LAYOUTS];
+	uint32 layout_count;
+	Laid_Out_Glyph arena[TEXT_LAYOUT_ARENA_GLYPHS];
+	uint32 arena_used;
+};
+
+global_variable Text_Layout_Cache layout_cache;
+global_variable Laid_Out_Glyph uncached_glyphs[MAX_GLYPHS_PER_FONT]; // draw_text_uncached lays out in here
+
+struct Text_Frame {
+	VkBuffer buffer;
+	Memory_Allocation memory;
+	Glyph_Instance *instances; // mapped, font i starts at i * MAX_GLYPHS_PER_FONT
+	uint32 glyph_counts[FONT_COUNT];
+
+	// the distance fields of this frame's new glyphs, one cell sized block each
+	VkBuffer staging_buffer;
+	Memory_Allocation staging_memory;
+};
+
+global_variable Text_Frame text_frames[MAX_FRAMES_IN_FLIGHT];
+
+internal_function bool load_font(Font *font) {
+	uint32 bytes_read = platform_read_file(font->file_path, &font->file);
+	if (bytes_read == 0) {
+		platform_log("Fatal: Failed to read the font %s!\n", font->file_path);
+		return false;
+	}
+
+	const unsigned char *data = reinterpret_cast<const unsigned char *>(font->file.data);
+	if (!stbtt_InitFont(&font->info, data, stbtt_GetFontOffsetForIndex(data, 0))) {
+		platform_log("Fatal: %s is not a font stb_truetype can read!\n", font->file_path);
+		platform_free_file(&font->file);
+		return false;
+	}
+
+	int ascent, descent, line_gap;
+	stbtt_GetFontVMetrics(&font->info, &ascent, &descent, &line_gap);
+	font->sdf_scale = stbtt_ScaleForPixelHeight(&font->info, SDF_PIXEL_HEIGHT);
+	font->ascent = ascent * font->sdf_scale;
+	font->line_height = (ascent - descent + line_gap) * font->sdf_scale;
+
+	return true;
+}
+
+internal_function uint32 decode_utf8(const unsigned char **text) {
+	const unsigned char *s = *text;
+	uint32 codepoint;
+	uint32 length;
+	if (s[0] < 0x80)                { codepoint = s[0];        length = 1; }
+	else if ((s[0] & 0xE0) == 0xC0) { codepoint = s[0] & 0x1F; length = 2; }
+	else if ((s[0] & 0xF0) == 0xE0) { codepoint = s[0] & 0x0F; length = 3; }
+	else if ((s[0] & 0xF8) == 0xF0) { codepoint = s[0] & 0x07; length = 4; }
+	else {
+		*text = s + 1;
+		return 0xFFFD; // replacement character
+	}
+
+	for (uint32 i = 1; i < length; ++i) {
+		if ((s[i] & 0xC0) != 0x80) { // also stops at the terminator
+			*text = s + i;
+			return 0xFFFD;
+		}
+		codepoint = (codepoint << 6) | (s[i] & 0x3F);
+	}
+
+	*text = s + length;
+	return codepoint;
+}
+
+internal_function Glyph *get_glyph(Font_Id font_id, uint32 codepoint, uint64 *key) {
+	*key = ((uint64)font_id << 32) | codepoint;
+	auto it = glyph_cache.glyphs.find(*key);
+	if (it != glyph_cache.glyphs.end()) return &it->second;
+
+	// NOTE: the same box computation stbtt_GetGlyphSDF does, so the metrics match the field without rasterizing it
+	Font *font = &fonts[font_id];
+	Glyph glyph = {};
+	glyph.key = *key;
+	glyph.glyph_index = stbtt_FindGlyphIndex(&font->info, codepoint);
+	glyph.cell = NO_GLYPH_CELL;
+
+	int advance, left_side_bearing;
+	stbtt_GetGlyphHMetrics(&font->info, glyph.glyph_index, &advance, &left_side_bearing);
+	glyph.advance = advance * font->sdf_scale;
+
+	int x0, y0, x1, y1;
+	stbtt_GetGlyphBitmapBox(&font->info, glyph.glyph_index, font->sdf_scale, font->sdf_scale, &x0, &y0, &x1, &y1);
+	glyph.empty = x0 == x1 || y0 == y1;
+	if (!glyph.empty) {
+		glyph.x_offset = (real32)(x0 - SDF_PADDING);
+		glyph.y_offset = (real32)(y0 - SDF_PADDING);
+		glyph.width = (uint32)(x1 - x0 + 2 * SDF_PADDING);
+		glyph.height = (uint32)(y1 - y0 + 2 * SDF_PADDING);
+		if (glyph.width > GLYPH_CELL_SIZE) glyph.width = GLYPH_CELL_SIZE;
+		if (glyph.height > GLYPH_CELL_SIZE) glyph.height = GLYPH_CELL_SIZE;
+	}
+
+	return &glyph_cache.glyphs.emplace(*key, glyph).first->second;
+}
+
+internal_function uint32 allocate_glyph_cell() {
+	if (!glyph_cache.free_cells.empty()) {
+		uint32 cell = glyph_cache.free_cells.back();
+		glyph_cache.free_cells.pop_back();
+		return cell;
+	}
+
+	// least recently used; anything drawn this frame has to stay, earlier frames in flight are fine because the
+	// upload pass waits for all earlier work on the queue before it writes
+	uint32 oldest = NO_GLYPH_CELL;
+	for (uint32 i = 0; i < GLYPH_CELL_COUNT; ++i) {
+		const Glyph_Cell &cell = glyph_cache.cells[i];
+		if (cell.last_used_frame == glyph_cache.frame) continue;
+		if (oldest == NO_GLYPH_CELL || cell.last_used_frame < glyph_cache.cells[oldest].last_used_frame) oldest = i;
+	}
+	if (oldest == NO_GLYPH_CELL) return NO_GLYPH_CELL;
+
+	glyph_cache.glyphs[glyph_cache.cells[oldest].key].cell = NO_GLYPH_CELL;
+	return oldest;
+}
+
+// makes sure the glyph has a cell with its distance field in it (by the time the frame's passes run)
+internal_function bool make_glyph_resident(Font_Id font_id, Glyph *glyph, uint64 key) {
+	if (glyph->cell != NO_GLYPH_CELL) {
+		glyph_cache.cells[glyph->cell].last_used_frame = glyph_cache.frame;
+		return true;
+	}
+	if (glyph_cache.uploads.size() >= MAX_GLYPH_UPLOADS_PER_FRAME) return false;
+
+	uint32 cell = allocate_glyph_cell();
+	if (cell == NO_GLYPH_CELL) return false; // every cell is on screen this frame
+
+	Font *font = &fonts[font_id];
+	int width, height, x_offset, y_offset;
+	unsigned char *field = stbtt_GetGlyphSDF(&font->info, font->sdf_scale, glyph->glyph_index, SDF_PADDING, SDF_ON_EDGE, SDF_PIXEL_DIST_SCALE, &width, &height, &x_offset, &y_offset);
+
+	// the whole cell gets written, so nothing of the glyph that was in it before bleeds in through filtering
+	Text_Frame *text_frame = &text_frames[c.current_frame];
+	VkDeviceSize staging_offset = glyph_cache.uploads.size() * GLYPH_CELL_SIZE * GLYPH_CELL_SIZE;
+	uint8 *staging = static_cast<uint8 *>(text_frame->staging_memory.mapped) + staging_offset;
+	memset(staging, 0, GLYPH_CELL_SIZE * GLYPH_CELL_SIZE);
+	if (field) {
+		uint32 copy_width = width < (int)GLYPH_CELL_SIZE ? (uint32)width : GLYPH_CELL_SIZE;
+		uint32 copy_height = height < (int)GLYPH_CELL_SIZE ? (uint32)height : GLYPH_CELL_SIZE;
+		for (uint32 y = 0; y < copy_height; ++y) {
+			memcpy(staging + y * GLYPH_CELL_SIZE, field + y * width, copy_width);
+		}
+		stbtt_FreeSDF(field, 0);
+	}
+
+	glyph_cache.cells[cell] = { key, glyph_cache.frame, true };
+	glyph_cache.uploads.push_back({ cell, staging_offset });
+	glyph->cell = cell;
+
+	return true;
+}
+
+internal_function uint64 hash_text(const char *text, real32 size, Font_Id font, uint32 *length) {
+	// the bytes, then the font and size
+	uint64 hash = hash_string(text, HASH_SEED, length);
+
+	uint32 tail[2];
+	memcpy(&tail[0], &size, sizeof(size));
+	tail[1] = (uint32)font;
+	return hash_bytes(tail, sizeof(tail), hash);
+}
+
+// lays out at most max_glyphs glyphs relative to the top left of the text, returns how many it wrote
+internal_function uint32 layout_text(const char *text, real32 size, Font_Id font, Laid_Out_Glyph *glyphs, uint32 max_glyphs) {
+	Font *f = &fonts[font];
+	real32 scale = size / SDF_PIXEL_HEIGHT;
+
+	uint32 count = 0;
+	real32 x = 0.0f;
+	real32 baseline = f->ascent * scale;
+	const unsigned char *ch = reinterpret_cast<const unsigned char *>(text);
+	while (*ch && count < max_glyphs) {
+		uint32 codepoint = decode_utf8(&ch);
+		if (codepoint == '\n') {
+			x = 0.0f;
+			baseline += f->line_height * scale;
 			continue;
 		}
 
-		const uint indices[] = {
-			0, 1, 2, 2, 3, 0
+		uint64 key;
+		Glyph *glyph = get_glyph(font, codepoint, &key);
+		if (!glyph->empty) {
+			glyphs[count++] = {
+				.glyph = glyph,
+				.offset = { x + glyph->x_offset * scale, baseline + glyph->y_offset * scale },
+				.size = { glyph->width * scale, glyph->height * scale },
+			};
+		}
+
+		x += glyph->advance * scale;
+	}
+
+	return count;
+}
+
+// drops the least recently used layouts until needed more glyphs and one more layout fit, then moves the
+// remaining ones to the front of the arena so the free space is in one piece
+internal_function void evict_text_layouts(uint32 needed) {
+	Text_Layout *layouts = layout_cache.layouts;
+	std::sort(layouts, layouts + layout_cache.layout_count, [](const Text_Layout &a, const Text_Layout &b) {
+		return a.last_used_frame > b.last_used_frame;
+	});
+
+	uint32 kept = 0;
+	uint32 kept_glyphs = 0;
+	while (kept < layout_cache.layout_count && kept + 1 < MAX_TEXT_LAYOUTS && kept_glyphs + layouts[kept].count + needed <= TEXT_LAYOUT_ARENA_GLYPHS) {
+		kept_glyphs += layouts[kept].count;
+		++kept;
+	}
+	layout_cache.layout_count = kept;
+
+	// in arena order every layout moves down (or stays), so memmove never overwrites one that is still to come
+	std::sort(layouts, layouts + kept, [](const Text_Layout &a, const Text_Layout &b) {
+		return a.first < b.first;
+	});
+
+	layout_cache.lookup.clear();
+	uint32 cursor = 0;
+	for (uint32 i = 0; i < kept; ++i) {
+		Text_Layout &layout = layouts[i];
+		if (layout.first != cursor) {
+			memmove(layout_cache.arena + cursor, layout_cache.arena + layout.first, layout.count * sizeof(Laid_Out_Glyph));
+			layout.first = cursor;
+		}
+		cursor += layout.count;
+		layout_cache.lookup[layout.hash] = i;
+	}
+	layout_cache.arena_used = cursor;
+}
+
+// NOTE: a hit is only checked by hash, with 64 bits a collision between strings on screen is not a real concern
+internal_function const Text_Layout *get_text_layout(uint64 hash, const char *text, uint32 length, real32 size, Font_Id font) {
+	auto it = layout_cache.lookup.find(hash);
+	if (it != layout_cache.lookup.end()) {
+		Text_Layout *layout = &layout_cache.layouts[it->second];
+		layout->last_used_frame = glyph_cache.frame;
+		return layout;
+	}
+
+	// every byte is at most one glyph, more than a frame can draw would be dropped anyway
+	uint32 needed = length < MAX_GLYPHS_PER_FONT ? length : MAX_GLYPHS_PER_FONT;
+	if (layout_cache.layout_count == MAX_TEXT_LAYOUTS || layout_cache.arena_used + needed > TEXT_LAYOUT_ARENA_GLYPHS) {
+		evict_text_layouts(needed);
+	}
+
+	uint32 index = layout_cache.layout_count++;
+	Text_Layout *layout = &layout_cache.layouts[index];
+	layout->hash = hash;
+	layout->first = layout_cache.arena_used;
+	layout->count = layout_text(text, size, font, layout_cache.arena + layout->first, needed);
+	layout->last_used_frame = glyph_cache.frame;
+	layout_cache.arena_used += layout->count;
+	layout_cache.lookup[hash] = index;
+
+	return layout;
+}
+
+// turns a layout into this frame's glyph instances
+internal_function void emit_glyphs(Vec2 top_left, const Laid_Out_Glyph *glyphs, uint32 glyph_count, Font_Id font, uint32 color) {
+	Text_Frame *text_frame = &text_frames[c.current_frame];
+	uint32 &count = text_frame->glyph_counts[font];
+	Glyph_Instance *instances = text_frame->instances + font * MAX_GLYPHS_PER_FONT;
+
+	for (uint32 i = 0; i < glyph_count; ++i) {
+		Glyph *glyph = glyphs[i].glyph;
+		if (!make_glyph_resident(font, glyph, glyph->key)) continue; // shows up next frame
+
+		if (count >= MAX_GLYPHS_PER_FONT) {
+			platform_log("Warning: Too much text this frame, the rest is dropped!\n");
+			return;
+		}
+
+		Vec2 cell_origin = {
+			(real32)((glyph->cell % GLYPH_CELLS_PER_ROW) * GLYPH_CELL_SIZE),
+			(real32)((glyph->cell / GLYPH_CELLS_PER_ROW) * GLYPH_CELL_SIZE),
+		};
+		instances[count++] = {
+			.position = { top_left.x + glyphs[i].offset.x, top_left.y + glyphs[i].offset.y },
+			.size = glyphs[i].size,
+			.uv_min = { cell_origin.x / GLYPH_ATLAS_SIZE, cell_origin.y / GLYPH_ATLAS_SIZE },
+			.uv_max = { (cell_origin.x + glyph->width) / GLYPH_ATLAS_SIZE, (cell_origin.y + glyph->height) / GLYPH_ATLAS_SIZE },
+			.color = color,
+		};
+	}
+}
+
+internal_function void record_glyph_uploads(VkCommandBuffer command_buffer, void *user_data) {
+	Text_Frame *text_frame = &text_frames[c.current_frame];
+
+	VkBufferImageCopy regions[MAX_GLYPH_UPLOADS_PER_FRAME];
+	uint32 region_count = 0;
+	for (const Glyph_Upload &upload : glyph_cache.uploads) {
+		regions[region_count++] = {
+			.bufferOffset = upload.staging_offset,
+			.bufferRowLength = GLYPH_CELL_SIZE,
+			.bufferImageHeight = GLYPH_CELL_SIZE,
+			.imageSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 },
+			.imageOffset = { (int32)((upload.cell % GLYPH_CELLS_PER_ROW) * GLYPH_CELL_SIZE), (int32)((upload.cell / GLYPH_CELLS_PER_ROW) * GLYPH_CELL_SIZE), 0 },
+			.imageExtent = { GLYPH_CELL_SIZE, GLYPH_CELL_SIZE, 1 },
 		};
+	}
+
+	vkCmdCopyBufferToImage(command_buffer, text_frame->staging_buffer, glyph_cache.atlas.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, region_count, regions);
+}
+
+//
+// Exported
+//
+
+bool load_default_fonts() {
+	for (uint32 i = 0; i < FONT_COUNT; ++i) {
+		bool result = load_font(&fonts[i]);
+		if (!result) return false;
+	}
+
+	// distance fields want bilinear filtering, and clamping keeps the edge cells from sampling the other side
+	bool result = create_empty_texture(GLYPH_ATLAS_SIZE, GLYPH_ATLAS_SIZE, VK_FORMAT_R8_UNORM, SAMPLER_LINEAR_CLAMP, &glyph_cache.atlas);
+	if (!result) {
+		platform_log("Fatal: Failed to create the glyph atlas!\n");
+		return false;
+	}
+	glyph_cache.atlas_layout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+	glyph_cache.free_cells.clear();
+	for (uint32 i = GLYPH_CELL_COUNT; i > 0; --i) {
+		glyph_cache.free_cells.push_back(i - 1);
+	}
+
+	return true;
+}
+
+void free_default_fonts() {
+	destroy_texture(&glyph_cache.atlas);
+	glyph_cache.glyphs.clear();
+	glyph_cache.free_cells.clear();
+	glyph_cache.uploads.clear();
+	layout_cache.lookup.clear();
+	layout_cache.layout_count = 0;
+	layout_cache.arena_used = 0;
+
+	for (uint32 i = 0; i < FONT_COUNT; ++i) {
+		if (fonts[i].file.data) platform_free_file(&fonts[i].file);
+	}
+}
+
+bool create_text_buffers() {
+	VkDeviceSize size = FONT_COUNT * MAX_GLYPHS_PER_FONT * sizeof(Glyph_Instance);
+	VkDeviceSize staging_size = MAX_GLYPH_UPLOADS_PER_FRAME * GLYPH_CELL_SIZE * GLYPH_CELL_SIZE;
+
+	for (uint32 frame = 0; frame < c.frames_in_flight; ++frame) {
+		Text_Frame *text_frame = &text_frames[frame];
+
+		// written by the cpu every frame and read once by the gpu, video memory only if the cpu can write it directly
+		bool result = create_buffer(size, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, text_frame->buffer, text_frame->memory, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+		if (!result) {
+			platform_log("Fatal: Failed to create a glyph instance buffer!\n");
+			return false;
+		}
 
-		// @ToDo: create font atlas as a combined image sampler to sample from later on
+		result = create_buffer(staging_size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, text_frame->staging_buffer, text_frame->staging_memory);
+		if (!result) {
+			platform_log("Fatal: Failed to create a glyph staging buffer!\n");
+			return false;
+		}
+
+		text_frame->instances = static_cast<Glyph_Instance *>(text_frame->memory.mapped);
+		for (uint32 font = 0; font < FONT_COUNT; ++font) {
+			text_frame->glyph_counts[font] = 0;
+		}
 	}
 
-	delete[] temp_bitmap;
+	return true;
+}
+
+void destroy_text_buffers() {
+	for (uint32 frame = 0; frame < c.frames_in_flight; ++frame) {
+		Text_Frame *text_frame = &text_frames[frame];
+		defer_destroy_buffer(text_frame->buffer, text_frame->memory);
+		defer_destroy_buffer(text_frame->staging_buffer, text_frame->staging_memory);
+		*text_frame = {};
+	}
+}
+
+void text_begin_frame() {
+	Text_Frame *text_frame = &text_frames[c.current_frame];
+	for (uint32 font = 0; font < FONT_COUNT; ++font) {
+		text_frame->glyph_counts[font] = 0;
+	}
+
+	++glyph_cache.frame;
+	glyph_cache.uploads.clear();
+}
+
+void draw_text(Vec2 top_left, const char *text, real32 size, Font_Id font, uint32 color) {
+	uint32 length;
+	uint64 hash = hash_text(text, size, font, &length);
+
+	const Text_Layout *layout = get_text_layout(hash, text, length, size, font);
+	emit_glyphs(top_left, layout_cache.arena + layout->first, layout->count, font, color);
+}
+
+void draw_text_uncached(Vec2 top_left, const char *text, real32 size, Font_Id font, uint32 color) {
+	uint32 count = layout_text(text, size, font, uncached_glyphs, MAX_GLYPHS_PER_FONT);
+	emit_glyphs(top_left, uncached_glyphs, count, font, color);
 }
 
-stbtt_bakedchar *get_cdata() {
-	return cdata;
+Render_Resource add_glyph_upload_pass() {
+	if (glyph_cache.uploads.empty()) return INVALID_RENDER_RESOURCE;
+
+	VkExtent2D extent = { GLYPH_ATLAS_SIZE, GLYPH_ATLAS_SIZE };
+	Render_Resource atlas = render_graph_import_image(glyph_cache.atlas.image, glyph_cache.atlas.image_view, VK_FORMAT_R8_UNORM, extent, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, glyph_cache.atlas_layout);
+	glyph_cache.atlas_layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+	Render_Pass pass = render_graph_add_pass("glyph upload", record_glyph_uploads, 0, RENDER_PASS_NO_RENDERING);
+	render_graph_write(pass, atlas, RENDER_ACCESS_TRANSFER_DST);
+
+	return atlas;
+}
+
+void record_text_draws(VkCommandBuffer command_buffer) {
+	Text_Frame *text_frame = &text_frames[c.current_frame];
+
+	bool any_text = false;
+	for (uint32 font = 0; font < FONT_COUNT; ++font) {
+		if (text_frame->glyph_counts[font] > 0) any_text = true;
+	}
+	if (!any_text) return;
+
+	vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, c.graphics_pipeline[PIPELINE_FONT]);
+
+	VkDeviceSize offset = 0;
+	vkCmdBindVertexBuffers(command_buffer, 0, 1, &text_frame->buffer, &offset);
+
+	Vec2 screen_size = { static_cast<float>(c.swapchain_image_extent.width), static_cast<float>(c.swapchain_image_extent.height) };
+	vkCmdPushConstants(command_buffer, c.pipeline_layout, PUSH_CONSTANT_STAGES, 0, sizeof(Vec2), &screen_size);
+
+	// NOTE: all fonts share the atlas, the draws are per font so each font's instances stay one contiguous range
+	uint32 texture_indices[2] = { glyph_cache.atlas.descriptor_index, glyph_cache.atlas.sampler_index };
+	vkCmdPushConstants(command_buffer, c.pipeline_layout, PUSH_CONSTANT_STAGES, sizeof(Vec2), sizeof(texture_indices), texture_indices);
+
+	for (uint32 font = 0; font < FONT_COUNT; ++font) {
+		uint32 glyph_count = text_frame->glyph_counts[font];
+		if (glyph_count == 0) continue;
+
+		vkCmdDraw(command_buffer, 6, glyph_count, 0, font * MAX_GLYPHS_PER_FONT);
+	}
 }
@@ -1,8 +1,60 @@
 #ifndef FONTS_H
 #define FONTS_H
 
+#include "types.hpp"
+#include "math.hpp"
+#include "renderer/render_graph.hpp"
+
 #include <lib/stb_truetype.h>
+#include <vulkan/vulkan.h>
+
+// NOTE: text is batched: draw_text turns a string into one glyph quad instance per character, written straight
+// into this frame's instance buffer. Every font owns a fixed region of that buffer, so the whole frame's text
+// is one instanced draw per font (6 vertices per instance, the vertex shader builds the quad).
+//
+// Glyphs are signed distance fields rasterized on first use into cells of one shared atlas, so a single atlas
+// entry serves every text size and any codepoint the font has. When the atlas is full the least recently used
+// cell that isn't drawn this frame is evicted. New glyphs reach the atlas through a transfer pass in the frame's
+// render graph (add_glyph_upload_pass).
+//
+// Layouts are cached by a hash of text, font and size, so a string that stays the same is not walked glyph by
+// glyph again; only text that changed gets laid out. Text that changes every frame (timings, counters) would only
+// push the other layouts out of the cache, it goes through draw_text_uncached instead.
+enum Font_Id {
+	FONT_DEFAULT = 0,
+	FONT_COUNT   = 1,
+};
+
+constexpr uint32 MAX_GLYPHS_PER_FONT = 8 * 1024; // per frame
+constexpr uint32 TEXT_COLOR_WHITE = 0xFFFFFFFF;  // R8G8B8A8, red in the lowest byte
+constexpr real32 DEFAULT_TEXT_SIZE = 32.0f;      // pixels from the top of a line to the bottom
+
+// per instance vertex data of the font pipeline (VERTEX_LAYOUT_GLYPH_INSTANCE)
+struct Glyph_Instance {
+	Vec2 position; // top left, in pixels
+	Vec2 size;     // in pixels
+	Vec2 uv_min;
+	Vec2 uv_max;
+	uint32 color;
+};
+
+// loads the font files and creates the (empty) glyph atlas
+bool load_default_fonts();
+bool create_text_buffers();
+// the atlas and buffers go through the deletion queue
+void free_default_fonts();
+void destroy_text_buffers();
 
-stbtt_bakedchar *get_cdata();
+// after the frame's fence was waited on; forgets the text of the last use of this frame in flight
+void text_begin_frame();
+// top_left is in pixels, text is utf-8; only call from one thread, before the text draw range gets recorded
+void draw_text(Vec2 top_left, const char *text, real32 size = DEFAULT_TEXT_SIZE, Font_Id font = FONT_DEFAULT, uint32 color = TEXT_COLOR_WHITE);
+// same as draw_text, but the layout is thrown away right after, it never touches the layout cache
+void draw_text_uncached(Vec2 top_left, const char *text, real32 size = DEFAULT_TEXT_SIZE, Font_Id font = FONT_DEFAULT, uint32 color = TEXT_COLOR_WHITE);
+// after all draw_text calls of the frame: adds the pass that copies new glyphs into the atlas. Passes that draw
+// text have to read the returned resource; INVALID_RENDER_RESOURCE if no glyph was added this frame.
+Render_Resource add_glyph_upload_pass();
+// binds the font pipeline and issues one draw per font that has text this frame
+void record_text_draws(VkCommandBuffer command_buffer);
 
 #endif
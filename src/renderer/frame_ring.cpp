@@ -0,0 +1,84 @@
+#include "frame_ring.hpp"
+
+#include "platform.hpp"
+#include "renderer/vulkan_init.hpp"
+#include "renderer/vulkan_helper.hpp"
+#include "renderer/deletion_queue.hpp"
+
+#include <vulkan/vulkan.h>
+
+#include <atomic>
+
+//
+// Internal
+//
+
+struct Frame_Ring {
+	VkBuffer buffer;
+	Memory_Allocation memory;
+	uint8 *mapped;
+	VkDeviceSize min_alignment; // minUniformBufferOffsetAlignment
+	std::atomic<VkDeviceSize> used; // in the current frame's region
+};
+
+global_variable Frame_Ring ring;
+
+//
+// Exported
+//
+
+bool frame_ring_init() {
+	VkPhysicalDeviceProperties properties;
+	vkGetPhysicalDeviceProperties(c.physical_device, &properties);
+	ring.min_alignment = properties.limits.minUniformBufferOffsetAlignment;
+	if (ring.min_alignment == 0) ring.min_alignment = 1;
+
+	VkDeviceSize size = FRAME_RING_REGION_SIZE * c.frames_in_flight;
+	VkBufferUsageFlags usage_flags = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT;
+	// host visible is a must, device local on top (UMA, resizable BAR) saves the gpu reads over the bus
+	bool result = create_buffer(size, usage_flags, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, ring.buffer, ring.memory, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+	if (!result) {
+		platform_log("Fatal: Failed to create the frame ring buffer!\n");
+		return false;
+	}
+
+	// NOTE: mapped once for the whole run, coherent memory needs no flushes
+	ring.mapped = static_cast<uint8 *>(ring.memory.mapped);
+	ring.used = 0;
+
+	return true;
+}
+
+void frame_ring_shutdown() {
+	defer_destroy_buffer(ring.buffer, ring.memory);
+	ring.buffer = VK_NULL_HANDLE;
+	ring.memory = {};
+	ring.mapped = 0;
+}
+
+void frame_ring_begin_frame() {
+	ring.used = 0;
+}
+
+bool frame_ring_allocate(VkDeviceSize size, VkDeviceSize alignment, Frame_Allocation *allocation) {
+	if (alignment < ring.min_alignment) alignment = ring.min_alignment;
+
+	// NOTE: the alignment padding is reserved along with the size, so concurrent allocations never overlap
+	VkDeviceSize reserved = ring.used.fetch_add(size + alignment - 1);
+	VkDeviceSize offset = (reserved + alignment - 1) / alignment * alignment;
+	if (offset + size > FRAME_RING_REGION_SIZE) {
+		platform_log("Fatal: The frame ring is full, %llu bytes per frame are not enough!\n", (unsigned long long)FRAME_RING_REGION_SIZE);
+		return false;
+	}
+
+	VkDeviceSize region_offset = c.current_frame * FRAME_RING_REGION_SIZE;
+	allocation->mapped = ring.mapped + region_offset + offset;
+	allocation->buffer = ring.buffer;
+	allocation->offset = static_cast<uint32>(region_offset + offset);
+
+	return true;
+}
+
+VkBuffer frame_ring_buffer() {
+	return ring.buffer;
+}
@@ -0,0 +1,29 @@
+#ifndef FRAME_RING_H
+#define FRAME_RING_H
+
+#include "types.hpp"
+
+#include <vulkan/vulkan.h>
+
+// NOTE: one persistently mapped buffer, split into a region per frame in flight. Everything the cpu writes fresh
+// every frame (uniforms, dynamic vertices) is bump allocated from the current frame's region and written with a
+// plain memcpy, no staging and no extra submit. A region is reused once its frame's fence was waited on, so
+// nothing in it is overwritten while the gpu reads it. Uniforms get bound with their offset as a dynamic offset.
+constexpr VkDeviceSize FRAME_RING_REGION_SIZE = 1024 * 1024; // per frame in flight
+
+struct Frame_Allocation {
+	void *mapped;
+	VkBuffer buffer;
+	uint32 offset; // from the start of buffer, usable as a dynamic offset
+};
+
+bool frame_ring_init();
+void frame_ring_shutdown();
+
+// after the frame's fence was waited on: everything allocated the last time this frame was in flight is gone
+void frame_ring_begin_frame();
+// thread safe; alignment is a power of two, the offset is also aligned to minUniformBufferOffsetAlignment
+bool frame_ring_allocate(VkDeviceSize size, VkDeviceSize alignment, Frame_Allocation *allocation);
+VkBuffer frame_ring_buffer();
+
+#endif
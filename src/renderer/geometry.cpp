@@ -0,0 +1,146 @@
+#include "geometry.hpp"
+
+#include "platform.hpp"
+#include "renderer/vulkan_init.hpp"
+#include "renderer/vulkan_helper.hpp"
+#include "renderer/upload.hpp"
+#include "renderer/deletion_queue.hpp"
+
+#include <vulkan/vulkan.h>
+
+#include <string.h>
+
+//
+// Internal
+//
+
+global_variable Geometry_Buffer geometry = {};
+
+// the first range that holds count elements shrinks from the front; false if none does
+internal_function bool allocate_range(std::vector<Geometry_Range> &free_ranges, uint32 count, uint32 *offset) {
+	for (size_t i = 0; i < free_ranges.size(); ++i) {
+		Geometry_Range &range = free_ranges[i];
+		if (range.count < count) continue;
+
+		*offset = range.offset;
+		range.offset += count;
+		range.count -= count;
+		if (range.count == 0) free_ranges.erase(free_ranges.begin() + i);
+		return true;
+	}
+
+	return false;
+}
+
+internal_function void free_range(std::vector<Geometry_Range> &free_ranges, uint32 offset, uint32 count) {
+	if (count == 0) return;
+
+	size_t i = 0;
+	while (i < free_ranges.size() && free_ranges[i].offset < offset) ++i;
+
+	bool merges_previous = i > 0 && free_ranges[i - 1].offset + free_ranges[i - 1].count == offset;
+	bool merges_next = i < free_ranges.size() && offset + count == free_ranges[i].offset;
+	if (merges_previous && merges_next) {
+		free_ranges[i - 1].count += count + free_ranges[i].count;
+		free_ranges.erase(free_ranges.begin() + i);
+	}
+	else if (merges_previous) {
+		free_ranges[i - 1].count += count;
+	}
+	else if (merges_next) {
+		free_ranges[i].offset = offset;
+		free_ranges[i].count += count;
+	}
+	else {
+		free_ranges.insert(free_ranges.begin() + i, { offset, count });
+	}
+}
+
+// NOTE: free ranges never overlap what a frame in flight might be drawing (meshes come back through the deletion
+// queue), so writing directly never touches memory the gpu reads
+internal_function bool write_geometry(const Render_Buffer &render_buffer, VkDeviceSize offset, const void *data, VkDeviceSize size) {
+	if (is_directly_writable(render_buffer.memory)) {
+		memcpy(static_cast<uint8 *>(render_buffer.memory.mapped) + offset, data, size);
+		return true;
+	}
+
+	return upload_buffer(render_buffer.buffer, offset, data, size);
+}
+
+//
+// Exported
+//
+
+bool create_geometry_buffer() {
+	geometry.vertex_buffer.type = VERTEX_BUFFER;
+	bool result = create_buffer(MAX_GEOMETRY_VERTICES * sizeof(Vertex), VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, geometry.vertex_buffer.buffer, geometry.vertex_buffer.memory, DIRECT_WRITE_MEMORY);
+	if (!result) {
+		return false;
+	}
+
+	geometry.index_buffer.type = INDEX_BUFFER;
+	result = create_buffer(MAX_GEOMETRY_INDICES * sizeof(uint), VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, geometry.index_buffer.buffer, geometry.index_buffer.memory, DIRECT_WRITE_MEMORY);
+	if (!result) {
+		return false;
+	}
+
+	geometry.free_vertices = { { 0, MAX_GEOMETRY_VERTICES } };
+	geometry.free_indices = { { 0, MAX_GEOMETRY_INDICES } };
+
+	return true;
+}
+
+void destroy_geometry_buffer() {
+	defer_destroy_buffer(geometry.vertex_buffer.buffer, geometry.vertex_buffer.memory);
+	defer_destroy_buffer(geometry.index_buffer.buffer, geometry.index_buffer.memory);
+	geometry = {};
+}
+
+bool upload_mesh(const Vertex *vertices, uint32 vertex_count, const uint *indices, uint32 index_count, Mesh *mesh) {
+	uint32 vertex_offset = 0;
+	if (!allocate_range(geometry.free_vertices, vertex_count, &vertex_offset)) {
+		platform_log("Geometry buffer is full!\n");
+		return false;
+	}
+
+	uint32 first_index = 0;
+	if (!allocate_range(geometry.free_indices, index_count, &first_index)) {
+		free_range(geometry.free_vertices, vertex_offset, vertex_count);
+		platform_log("Geometry buffer is full!\n");
+		return false;
+	}
+
+	bool result = write_geometry(geometry.vertex_buffer, vertex_offset * sizeof(Vertex), vertices, vertex_count * sizeof(Vertex));
+	result = result && write_geometry(geometry.index_buffer, first_index * sizeof(uint), indices, index_count * sizeof(uint));
+	if (!result) {
+		free_range(geometry.free_vertices, vertex_offset, vertex_count);
+		free_range(geometry.free_indices, first_index, index_count);
+		return false;
+	}
+
+	// indices stay relative to the mesh, vertexOffset moves them to where the vertices ended up
+	mesh->index_count = index_count;
+	mesh->first_index = first_index;
+	mesh->vertex_offset = static_cast<int32>(vertex_offset);
+	mesh->vertex_count = vertex_count;
+	bool direct = is_directly_writable(geometry.vertex_buffer.memory) && is_directly_writable(geometry.index_buffer.memory);
+	mesh->upload_value = direct ? 0 : upload_get_recording_value();
+
+	return true;
+}
+
+void free_mesh(const Mesh &mesh) {
+	// after destroy_geometry_buffer the ranges are gone with the buffers
+	if (geometry.vertex_buffer.buffer == VK_NULL_HANDLE) return;
+
+	free_range(geometry.free_vertices, static_cast<uint32>(mesh.vertex_offset), mesh.vertex_count);
+	free_range(geometry.free_indices, mesh.first_index, mesh.index_count);
+}
+
+void bind_geometry_buffer(VkCommandBuffer command_buffer) {
+	VkBuffer vertex_buffers[] = { geometry.vertex_buffer.buffer };
+	VkDeviceSize offsets[] = { 0 };
+
+	vkCmdBindVertexBuffers(command_buffer, 0, 1, vertex_buffers, offsets);
+	vkCmdBindIndexBuffer(command_buffer, geometry.index_buffer.buffer, 0, VK_INDEX_TYPE_UINT32);
+}
@@ -0,0 +1,37 @@
+#ifndef GEOMETRY_H
+#define GEOMETRY_H
+
+#include "types.hpp"
+#include "assets.hpp"
+
+#include <vulkan/vulkan.h>
+
+#include <vector>
+
+// NOTE: all vertex and index data lives in one vertex buffer and one index buffer; meshes are ranges inside them.
+// Every buffer keeps a list of its free ranges, sorted by offset and merged with their neighbours when a range
+// comes back, and a mesh goes into the first one it fits (first fit). Meshes are freed through the deletion queue,
+// so a range is only handed out again once no frame in flight draws from it anymore.
+constexpr uint32 MAX_GEOMETRY_VERTICES = 64 * 1024;
+constexpr uint32 MAX_GEOMETRY_INDICES = 3 * MAX_GEOMETRY_VERTICES;
+
+struct Geometry_Range {
+	uint32 offset; // in vertices or indices
+	uint32 count;
+};
+
+struct Geometry_Buffer {
+	Render_Buffer vertex_buffer;
+	Render_Buffer index_buffer;
+	std::vector<Geometry_Range> free_vertices;
+	std::vector<Geometry_Range> free_indices;
+};
+
+bool create_geometry_buffer();
+void destroy_geometry_buffer();
+bool upload_mesh(const Vertex *vertices, uint32 vertex_count, const uint *indices, uint32 index_count, Mesh *mesh);
+// gives the mesh's ranges back right away, only call it once no frame in flight draws the mesh (defer_free_mesh)
+void free_mesh(const Mesh &mesh);
+void bind_geometry_buffer(VkCommandBuffer command_buffer);
+
+#endif
@@ -0,0 +1,145 @@
+#include "gpu_profiler.hpp"
+
+#include "platform.hpp"
+#include "game.hpp"
+#include "renderer/vulkan_init.hpp"
+
+#include <vulkan/vulkan.h>
+
+#include <atomic>
+
+//
+// Internal
+//
+
+// query 0 and 1 of every frame are the frame itself, scope i uses 2 + 2 * i and 3 + 2 * i
+constexpr uint32 GPU_QUERIES_PER_FRAME = 2 + 2 * MAX_GPU_SCOPES;
+
+struct Gpu_Profiler_Frame {
+	std::atomic<uint32> scope_count;
+	const char *names[MAX_GPU_SCOPES];
+	bool written; // recorded and submitted since the last reset, so the results are there once the fence retired
+};
+
+struct Gpu_Profiler {
+	bool enabled;
+	VkQueryPool query_pool;
+	real64 ns_per_tick;
+	uint64 valid_mask;
+	Gpu_Profiler_Frame frames[MAX_FRAMES_IN_FLIGHT];
+};
+
+global_variable Gpu_Profiler profiler;
+
+internal_function real64 ticks_to_ms(uint64 begin, uint64 end) {
+	uint64 ticks = (end - begin) & profiler.valid_mask;
+	return (real64)ticks * profiler.ns_per_tick / 1000000.0;
+}
+
+internal_function void collect_results(uint32 frame_index) {
+	Gpu_Profiler_Frame &frame = profiler.frames[frame_index];
+
+	uint32 scope_count = frame.scope_count.load();
+	if (scope_count > MAX_GPU_SCOPES) scope_count = MAX_GPU_SCOPES;
+
+	uint64 timestamps[GPU_QUERIES_PER_FRAME];
+	uint32 query_count = 2 + 2 * scope_count;
+	VkResult result = vkGetQueryPoolResults(c.device, profiler.query_pool, frame_index * GPU_QUERIES_PER_FRAME, query_count, sizeof(timestamps), timestamps, sizeof(uint64), VK_QUERY_RESULT_64_BIT);
+	if (result != VK_SUCCESS) return; // the fence retired, so this only happens if the frame was never submitted
+
+	perf_metrics.gpu_ms_per_frame = ticks_to_ms(timestamps[0], timestamps[1]);
+	perf_metrics.gpu_timing_count = scope_count;
+	for (uint32 i = 0; i < scope_count; ++i) {
+		perf_metrics.gpu_timings[i] = { frame.names[i], ticks_to_ms(timestamps[2 + 2 * i], timestamps[3 + 2 * i]) };
+	}
+}
+
+//
+// Exported
+//
+
+bool gpu_profiler_init() {
+	VkPhysicalDeviceProperties properties;
+	vkGetPhysicalDeviceProperties(c.physical_device, &properties);
+
+	uint32 queue_family_count = 0;
+	vkGetPhysicalDeviceQueueFamilyProperties(c.physical_device, &queue_family_count, 0);
+	VkQueueFamilyProperties *queue_families = new VkQueueFamilyProperties[queue_family_count];
+	vkGetPhysicalDeviceQueueFamilyProperties(c.physical_device, &queue_family_count, queue_families);
+	uint32 valid_bits = queue_families[c.graphics_family].timestampValidBits;
+	delete[] queue_families;
+
+	// NOTE: not having timestamps is not an error, the gpu timings just stay at zero
+	if (valid_bits == 0 || properties.limits.timestampPeriod == 0.0f) {
+		platform_log("The graphics queue doesn't support timestamps, gpu timings are disabled.\n");
+		profiler.enabled = false;
+		return true;
+	}
+
+	profiler.ns_per_tick = properties.limits.timestampPeriod;
+	profiler.valid_mask = valid_bits >= 64 ? ~0ull : (1ull << valid_bits) - 1;
+
+	VkQueryPoolCreateInfo pool_info = {
+		.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO,
+		.queryType = VK_QUERY_TYPE_TIMESTAMP,
+		.queryCount = GPU_QUERIES_PER_FRAME * c.frames_in_flight,
+	};
+	VkResult result = vkCreateQueryPool(c.device, &pool_info, 0, &profiler.query_pool);
+	if (result != VK_SUCCESS) {
+		platform_log("Fatal: Failed to create the timestamp query pool!\n");
+		return false;
+	}
+
+	for (Gpu_Profiler_Frame &frame : profiler.frames) {
+		frame.scope_count = 0;
+		frame.written = false;
+	}
+	profiler.enabled = true;
+
+	return true;
+}
+
+void gpu_profiler_shutdown() {
+	if (profiler.query_pool) vkDestroyQueryPool(c.device, profiler.query_pool, 0);
+	profiler.query_pool = VK_NULL_HANDLE;
+	profiler.enabled = false;
+}
+
+void gpu_profiler_begin_frame(VkCommandBuffer command_buffer) {
+	if (!profiler.enabled) return;
+
+	Gpu_Profiler_Frame &frame = profiler.frames[c.current_frame];
+	if (frame.written) collect_results(c.current_frame);
+
+	uint32 first_query = c.current_frame * GPU_QUERIES_PER_FRAME;
+	vkCmdResetQueryPool(command_buffer, profiler.query_pool, first_query, GPU_QUERIES_PER_FRAME);
+	vkCmdWriteTimestamp2(command_buffer, VK_PIPELINE_STAGE_2_TOP_OF_PIPE_BIT, profiler.query_pool, first_query);
+
+	frame.scope_count = 0;
+	frame.written = true;
+}
+
+void gpu_profiler_end_frame(VkCommandBuffer command_buffer) {
+	if (!profiler.enabled) return;
+
+	vkCmdWriteTimestamp2(command_buffer, VK_PIPELINE_STAGE_2_BOTTOM_OF_PIPE_BIT, profiler.query_pool, c.current_frame * GPU_QUERIES_PER_FRAME + 1);
+}
+
+uint32 gpu_profiler_begin_scope(VkCommandBuffer command_buffer, const char *name) {
+	if (!profiler.enabled) return INVALID_GPU_SCOPE;
+
+	Gpu_Profiler_Frame &frame = profiler.frames[c.current_frame];
+	uint32 scope = frame.scope_count.fetch_add(1);
+	if (scope >= MAX_GPU_SCOPES) return INVALID_GPU_SCOPE;
+
+	frame.names[scope] = name;
+	vkCmdWriteTimestamp2(command_buffer, VK_PIPELINE_STAGE_2_TOP_OF_PIPE_BIT, profiler.query_pool, c.current_frame * GPU_QUERIES_PER_FRAME + 2 + 2 * scope);
+
+	return scope;
+}
+
+void gpu_profiler_end_scope(VkCommandBuffer command_buffer, uint32 scope) {
+	if (!profiler.enabled || scope == INVALID_GPU_SCOPE) return;
+
+	vkCmdWriteTimestamp2(command_buffer, VK_PIPELINE_STAGE_2_BOTTOM_OF_PIPE_BIT, profiler.query_pool, c.current_frame * GPU_QUERIES_PER_FRAME + 3 + 2 * scope);
+}
@@ -0,0 +1,28 @@
+#ifndef GPU_PROFILER_H
+#define GPU_PROFILER_H
+
+#include "types.hpp"
+#include "game.hpp"
+
+#include <vulkan/vulkan.h>
+
+// NOTE: every frame in flight owns a range of a timestamp query pool. Scopes write a timestamp at their begin and
+// end, the results are read when the frame's fence has been waited on again (c.frames_in_flight frames later)
+// and end up in perf_metrics next to the cpu timings. Scopes can be opened from several threads at once (draw
+// ranges are recorded in parallel). If the graphics queue has no timestamps everything here does nothing.
+constexpr uint32 MAX_GPU_SCOPES = MAX_GPU_TIMINGS; // per frame
+constexpr uint32 INVALID_GPU_SCOPE = 0xFFFFFFFF;
+
+bool gpu_profiler_init();
+void gpu_profiler_shutdown();
+
+// right after the frame's fence was waited on and its command buffer begun: collects the results of the last
+// use of this frame in flight into perf_metrics and resets its queries
+void gpu_profiler_begin_frame(VkCommandBuffer command_buffer);
+// right before the frame's command buffer ends
+void gpu_profiler_end_frame(VkCommandBuffer command_buffer);
+// the name has to outlive the frame (string literals)
+uint32 gpu_profiler_begin_scope(VkCommandBuffer command_buffer, const char *name);
+void gpu_profiler_end_scope(VkCommandBuffer command_buffer, uint32 scope);
+
+#endif
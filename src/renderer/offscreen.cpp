@@ -0,0 +1,158 @@
+#include "offscreen.hpp"
+
+#include "platform.hpp"
+#include "renderer/vulkan_init.hpp"
+#include "renderer/vulkan_helper.hpp"
+
+#include <vulkan/vulkan.h>
+
+//
+// Internal
+//
+
+struct Offscreen_Target {
+	Memory_Allocation image_memory;
+	VkBuffer read_back_buffer;
+	Memory_Allocation read_back_memory;
+};
+
+struct Offscreen_Targets {
+	Offscreen_Target targets[MAX_FRAMES_IN_FLIGHT];
+	bool read_back;
+};
+
+global_variable Offscreen_Targets offscreen = {};
+
+internal_function bool create_offscreen_target(uint32 frame) {
+	Offscreen_Target *target = &offscreen.targets[frame];
+
+	VkImageCreateInfo image_info = {
+		.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
+		.imageType = VK_IMAGE_TYPE_2D,
+		.format = OFFSCREEN_FORMAT,
+		.extent = { c.swapchain_image_extent.width, c.swapchain_image_extent.height, 1 },
+		.mipLevels = 1,
+		.arrayLayers = 1,
+		.samples = VK_SAMPLE_COUNT_1_BIT,
+		.tiling = VK_IMAGE_TILING_OPTIMAL,
+		.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
+		.sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+		.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+	};
+	VkResult result = vkCreateImage(c.device, &image_info, 0, &c.swapchain_images[frame]);
+	if (result != VK_SUCCESS) {
+		platform_log("Fatal: Failed to create an offscreen image!\n");
+		return false;
+	}
+
+	VkMemoryRequirements memory_requirements;
+	vkGetImageMemoryRequirements(c.device, c.swapchain_images[frame], &memory_requirements);
+	bool res = allocate_memory(memory_requirements, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, MEMORY_RESOURCE_OPTIMAL, &target->image_memory);
+	if (!res) {
+		platform_log("Fatal: Failed to allocate memory for an offscreen image!\n");
+		return false;
+	}
+	vkBindImageMemory(c.device, c.swapchain_images[frame], target->image_memory.memory, target->image_memory.offset);
+
+	VkImageViewCreateInfo view_info = {
+		.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
+		.image = c.swapchain_images[frame],
+		.viewType = VK_IMAGE_VIEW_TYPE_2D,
+		.format = OFFSCREEN_FORMAT,
+		.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 },
+	};
+	result = vkCreateImageView(c.device, &view_info, 0, &c.swapchain_image_views[frame]);
+	if (result != VK_SUCCESS) {
+		platform_log("Fatal: Failed to create an offscreen image view!\n");
+		return false;
+	}
+
+	if (offscreen.read_back) {
+		VkDeviceSize size = (VkDeviceSize)c.swapchain_image_extent.width * c.swapchain_image_extent.height * OFFSCREEN_BYTES_PER_PIXEL;
+
+		// cached memory makes reading on the cpu a lot faster, not every device has it though
+		res = create_buffer(size, VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT | VK_MEMORY_PROPERTY_HOST_CACHED_BIT, target->read_back_buffer, target->read_back_memory);
+		if (!res) {
+			res = create_buffer(size, VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, target->read_back_buffer, target->read_back_memory);
+		}
+		if (!res) {
+			platform_log("Fatal: Failed to create an offscreen read back buffer!\n");
+			return false;
+		}
+	}
+
+	return true;
+}
+
+//
+// Exported
+//
+
+bool create_offscreen_targets(VkExtent2D extent, bool read_back) {
+	offscreen.read_back = read_back;
+
+	c.swapchain_image_format = OFFSCREEN_FORMAT;
+	c.swapchain_image_extent = extent;
+	c.swapchain_images.assign(c.frames_in_flight, VK_NULL_HANDLE);
+	c.swapchain_image_views.assign(c.frames_in_flight, VK_NULL_HANDLE);
+
+	for (uint32 frame = 0; frame < c.frames_in_flight; ++frame) {
+		bool result = create_offscreen_target(frame);
+		if (!result) return false;
+	}
+
+	return true;
+}
+
+void destroy_offscreen_targets() {
+	for (uint32 frame = 0; frame < c.swapchain_images.size(); ++frame) {
+		Offscreen_Target *target = &offscreen.targets[frame];
+
+		vkDestroyImageView(c.device, c.swapchain_image_views[frame], 0);
+		vkDestroyImage(c.device, c.swapchain_images[frame], 0);
+		if (target->image_memory.memory) free_memory(&target->image_memory);
+		if (target->read_back_buffer) destroy_buffer(target->read_back_buffer, target->read_back_memory);
+	}
+
+	c.swapchain_images.clear();
+	c.swapchain_image_views.clear();
+	offscreen = {};
+}
+
+bool offscreen_read_back_enabled() {
+	return offscreen.read_back;
+}
+
+void record_offscreen_read_back(VkCommandBuffer command_buffer, VkImage image) {
+	Offscreen_Target *target = &offscreen.targets[c.current_frame];
+
+	VkBufferImageCopy region = {
+		.bufferOffset = 0,
+		.bufferRowLength = 0, // tightly packed
+		.bufferImageHeight = 0,
+		.imageSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 },
+		.imageOffset = { 0, 0, 0 },
+		.imageExtent = { c.swapchain_image_extent.width, c.swapchain_image_extent.height, 1 },
+	};
+	vkCmdCopyImageToBuffer(command_buffer, image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, target->read_back_buffer, 1, &region);
+
+	// NOTE: waiting on the fence doesn't make the copy visible to the host by itself, this barrier does
+	VkMemoryBarrier2 host_barrier = {
+		.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2,
+		.srcStageMask = VK_PIPELINE_STAGE_2_COPY_BIT,
+		.srcAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT,
+		.dstStageMask = VK_PIPELINE_STAGE_2_HOST_BIT,
+		.dstAccessMask = VK_ACCESS_2_HOST_READ_BIT,
+	};
+	VkDependencyInfo dependency_info = {
+		.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
+		.memoryBarrierCount = 1,
+		.pMemoryBarriers = &host_barrier,
+	};
+	vkCmdPipelineBarrier2(command_buffer, &dependency_info);
+}
+
+const uint8 *get_offscreen_pixels(uint32 frame) {
+	if (!offscreen.read_back) return 0;
+	return static_cast<const uint8 *>(offscreen.targets[frame].read_back_memory.mapped);
+}
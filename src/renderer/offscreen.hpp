@@ -0,0 +1,23 @@
+#ifndef OFFSCREEN_H
+#define OFFSCREEN_H
+
+#include "types.hpp"
+
+#include <vulkan/vulkan.h>
+
+// NOTE: the headless backend has no surface and no swapchain. It renders into a ring of images, one per frame in
+// flight, that stand in for the swapchain images (c.swapchain_images), so the rest of the renderer doesn't care.
+// With read back enabled every frame is also copied into a host visible buffer of its frame in flight.
+constexpr VkFormat OFFSCREEN_FORMAT = VK_FORMAT_R8G8B8A8_SRGB;
+constexpr uint32 OFFSCREEN_BYTES_PER_PIXEL = 4;
+
+bool create_offscreen_targets(VkExtent2D extent, bool read_back);
+void destroy_offscreen_targets();
+
+bool offscreen_read_back_enabled();
+// copies the image of the current frame in flight into its read back buffer; the image has to be in TRANSFER_SRC_OPTIMAL
+void record_offscreen_read_back(VkCommandBuffer command_buffer, VkImage image);
+// tightly packed RGBA8 rows; only valid once the fence of that frame in flight has been waited on
+const uint8 *get_offscreen_pixels(uint32 frame);
+
+#endif
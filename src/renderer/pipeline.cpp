@@ -2,18 +2,50 @@
 
 #include "types.hpp"
 #include "assets.hpp"
+#include "fonts.hpp"
+#include "sprites.hpp"
 #include "platform.hpp"
+#include "hash.hpp"
 #include "vulkan_init.hpp"
+#include "jobs.hpp"
 
 #include <vulkan/vulkan.h>
 
+#include <string.h>
+#include <vector>
+
 //
 // INTERNAL
 //
 
-//struct Pipelines {
-//	
-//};
+// NOTE: the driver validates its own cache header too, but some drivers crash on caches from another driver
+// version instead of ignoring them, so we put our own header in front and only hand over data we wrote
+// ourselves for exactly this device and driver
+constexpr uint32 PIPELINE_CACHE_MAGIC = 0x48435050; // "PPCH"
+
+struct Pipeline_Cache_File_Header {
+	uint32 magic;
+	uint32 data_size;
+	uint64 data_hash;
+	uint32 vendor_id;
+	uint32 device_id;
+	uint32 driver_version;
+	uint8 uuid[VK_UUID_SIZE];
+};
+
+internal_function Pipeline_Cache_File_Header get_pipeline_cache_header() {
+	VkPhysicalDeviceProperties properties;
+	vkGetPhysicalDeviceProperties(c.physical_device, &properties);
+
+	Pipeline_Cache_File_Header header = {
+		.magic = PIPELINE_CACHE_MAGIC,
+		.vendor_id = properties.vendorID,
+		.device_id = properties.deviceID,
+		.driver_version = properties.driverVersion,
+	};
+	memcpy(header.uuid, properties.pipelineCacheUUID, VK_UUID_SIZE);
+	return header;
+}
 
 internal_function bool create_shader_module(const char *shader_file, VkShaderModule *shader_module) {
 	File_Asset file_asset = {};
@@ -39,42 +71,77 @@ internal_function bool create_shader_module(const char *shader_file, VkShaderMod
 }
 
 //
-// EXTERNAL
+// pipeline table; the index is the Pipeline_Id
 //
 
-bool create_default_pipeline() {
-	VkShaderModule vertex_shader_module = {};
-	bool shader_created = create_shader_module("res/shaders/default_vs.spv", &vertex_shader_module);
-	if (!shader_created) {
-		return false;
-	}
+global_variable const Pipeline_Description pipeline_descriptions[PIPELINE_COUNT] = {
+	// PIPELINE_DEFAULT
+	{
+		.vertex_shader = "res/shaders/default_vs.spv",
+		.fragment_shader = "res/shaders/default_fs.spv",
+	},
+	// PIPELINE_FONT
+	{
+		.vertex_shader = "res/shaders/font_vs.spv",
+		.fragment_shader = "res/shaders/font_fs.spv",
+		.vertex_layout = VERTEX_LAYOUT_GLYPH_INSTANCE,
+		.cull_mode = VK_CULL_MODE_NONE, // screen space quads, the winding doesn't matter
+	},
+	// PIPELINE_SPRITE
+	{
+		.vertex_shader = "res/shaders/sprite_vs.spv",
+		.fragment_shader = "res/shaders/sprite_fs.spv",
+		.vertex_layout = VERTEX_LAYOUT_SPRITE_INSTANCE,
+		.cull_mode = VK_CULL_MODE_NONE, // the quad is built in the shader, the winding doesn't matter
+	},
+};
+
+struct Pipeline_Compile_Job {
+	const Pipeline_Description *description;
+	VkShaderModule vertex_module;
+	VkShaderModule fragment_module;
+	VkPipeline pipeline;
+	VkResult result;
+};
+
+// everything we created, without the duplicates the dedup hands out twice
+global_variable std::vector<VkPipeline> unique_pipelines;
+
+// the hash only picks the candidates, two descriptions are the same pipeline if every field matches
+internal_function bool pipeline_descriptions_equal(const Pipeline_Description &a, const Pipeline_Description &b) {
+	return strcmp(a.vertex_shader, b.vertex_shader) == 0 &&
+		strcmp(a.fragment_shader, b.fragment_shader) == 0 &&
+		a.vertex_layout == b.vertex_layout &&
+		a.topology == b.topology &&
+		a.polygon_mode == b.polygon_mode &&
+		a.cull_mode == b.cull_mode &&
+		a.front_face == b.front_face &&
+		a.blend_mode == b.blend_mode;
+}
 
-	VkPipelineShaderStageCreateInfo vert_shader_stage_info = {
-		.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
-		.stage = VK_SHADER_STAGE_VERTEX_BIT,
-		.module = vertex_shader_module,
-		.pName = "main"
-	};
+internal_function void compile_pipeline_job(void *data) {
+	Pipeline_Compile_Job *job = static_cast<Pipeline_Compile_Job *>(data);
+	const Pipeline_Description &description = *job->description;
 
-	VkShaderModule fragment_shader_module = {};
-	shader_created = create_shader_module("res/shaders/default_fs.spv", &fragment_shader_module);
-	if (!shader_created) {
-		return false;
-	}
-
-	VkPipelineShaderStageCreateInfo frag_shader_stage_info = {
-		.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
-		.stage = VK_SHADER_STAGE_FRAGMENT_BIT,
-		.module = fragment_shader_module,
-		.pName = "main"
+	VkPipelineShaderStageCreateInfo shader_stage_create_infos[] = {
+		{
+			.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+			.stage = VK_SHADER_STAGE_VERTEX_BIT,
+			.module = job->vertex_module,
+			.pName = "main"
+		},
+		{
+			.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+			.stage = VK_SHADER_STAGE_FRAGMENT_BIT,
+			.module = job->fragment_module,
+			.pName = "main"
+		}
 	};
 
-	VkPipelineShaderStageCreateInfo shader_stage_create_infos[] = { vert_shader_stage_info, frag_shader_stage_info };
-
 	VkDynamicState dynamic_states[] = { VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR };
 	VkPipelineDynamicStateCreateInfo dynamic_state_info = {
 		.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO,
-		.dynamicStateCount = sizeof(shader_stage_create_infos) / sizeof(shader_stage_create_infos[0]),
+		.dynamicStateCount = sizeof(dynamic_states) / sizeof(dynamic_states[0]),
 		.pDynamicStates = dynamic_states
 	};
 
@@ -99,17 +166,60 @@ bool create_default_pipeline() {
 		}
 	};
 
+	VkVertexInputBindingDescription glyph_binding_description = {
+		.binding = 0,
+		.stride = sizeof(Glyph_Instance),
+		.inputRate = VK_VERTEX_INPUT_RATE_INSTANCE
+	};
+
+	VkVertexInputAttributeDescription glyph_attribute_descriptions[] = {
+		{ .location = 0, .binding = 0, .format = VK_FORMAT_R32G32_SFLOAT, .offset = offsetof(Glyph_Instance, position) },
+		{ .location = 1, .binding = 0, .format = VK_FORMAT_R32G32_SFLOAT, .offset = offsetof(Glyph_Instance, size) },
+		{ .location = 2, .binding = 0, .format = VK_FORMAT_R32G32_SFLOAT, .offset = offsetof(Glyph_Instance, uv_min) },
+		{ .location = 3, .binding = 0, .format = VK_FORMAT_R32G32_SFLOAT, .offset = offsetof(Glyph_Instance, uv_max) },
+		{ .location = 4, .binding = 0, .format = VK_FORMAT_R8G8B8A8_UNORM, .offset = offsetof(Glyph_Instance, color) },
+	};
+
+	VkVertexInputBindingDescription sprite_binding_description = {
+		.binding = 0,
+		.stride = sizeof(Sprite_Instance),
+		.inputRate = VK_VERTEX_INPUT_RATE_INSTANCE
+	};
+
+	VkVertexInputAttributeDescription sprite_attribute_descriptions[] = {
+		{ .location = 0, .binding = 0, .format = VK_FORMAT_R32G32_SFLOAT, .offset = offsetof(Sprite_Instance, position) },
+		{ .location = 1, .binding = 0, .format = VK_FORMAT_R32G32_SFLOAT, .offset = offsetof(Sprite_Instance, size) },
+		{ .location = 2, .binding = 0, .format = VK_FORMAT_R32G32_SFLOAT, .offset = offsetof(Sprite_Instance, uv_min) },
+		{ .location = 3, .binding = 0, .format = VK_FORMAT_R32G32_SFLOAT, .offset = offsetof(Sprite_Instance, uv_max) },
+		{ .location = 4, .binding = 0, .format = VK_FORMAT_R32_UINT, .offset = offsetof(Sprite_Instance, descriptor_index) },
+		{ .location = 5, .binding = 0, .format = VK_FORMAT_R32_UINT, .offset = offsetof(Sprite_Instance, layer) },
+	};
+
 	VkPipelineVertexInputStateCreateInfo vertex_input_info = {
 		.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO,
-		.vertexBindingDescriptionCount = 1,
-		.pVertexBindingDescriptions = &binding_description,
-		.vertexAttributeDescriptionCount = 2,
-		.pVertexAttributeDescriptions = attribute_descriptions
 	};
+	if (description.vertex_layout == VERTEX_LAYOUT_DEFAULT) {
+		vertex_input_info.vertexBindingDescriptionCount = 1;
+		vertex_input_info.pVertexBindingDescriptions = &binding_description;
+		vertex_input_info.vertexAttributeDescriptionCount = 2;
+		vertex_input_info.pVertexAttributeDescriptions = attribute_descriptions;
+	}
+	else if (description.vertex_layout == VERTEX_LAYOUT_GLYPH_INSTANCE) {
+		vertex_input_info.vertexBindingDescriptionCount = 1;
+		vertex_input_info.pVertexBindingDescriptions = &glyph_binding_description;
+		vertex_input_info.vertexAttributeDescriptionCount = sizeof(glyph_attribute_descriptions) / sizeof(glyph_attribute_descriptions[0]);
+		vertex_input_info.pVertexAttributeDescriptions = glyph_attribute_descriptions;
+	}
+	else if (description.vertex_layout == VERTEX_LAYOUT_SPRITE_INSTANCE) {
+		vertex_input_info.vertexBindingDescriptionCount = 1;
+		vertex_input_info.pVertexBindingDescriptions = &sprite_binding_description;
+		vertex_input_info.vertexAttributeDescriptionCount = sizeof(sprite_attribute_descriptions) / sizeof(sprite_attribute_descriptions[0]);
+		vertex_input_info.pVertexAttributeDescriptions = sprite_attribute_descriptions;
+	}
 
 	VkPipelineInputAssemblyStateCreateInfo input_assembly_info = {
 		.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO,
-		.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST,
+		.topology = description.topology,
 		.primitiveRestartEnable = VK_FALSE
 	};
 
@@ -118,18 +228,16 @@ bool create_default_pipeline() {
 	VkPipelineViewportStateCreateInfo viewport_info = {
 		.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO,
 		.viewportCount = 1,
-		//.pViewports = &viewport,
 		.scissorCount = 1,
-		//.pScissors = &scissors
 	};
 
 	VkPipelineRasterizationStateCreateInfo rasterization_info = {
 		.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO,
 		.depthClampEnable = VK_FALSE,
 		.rasterizerDiscardEnable = VK_FALSE,
-		.polygonMode = VK_POLYGON_MODE_FILL,
-		.cullMode = VK_CULL_MODE_BACK_BIT,
-		.frontFace = VK_FRONT_FACE_CLOCKWISE,
+		.polygonMode = description.polygon_mode,
+		.cullMode = description.cull_mode,
+		.frontFace = description.front_face,
 		.depthBiasEnable = VK_FALSE, // NOTE: this could be used for shadow mapping
 		.lineWidth = 1.0f
 	};
@@ -141,7 +249,7 @@ bool create_default_pipeline() {
 	};
 
 	VkPipelineColorBlendAttachmentState color_blend_attachment = {
-		.blendEnable = VK_TRUE,
+		.blendEnable = description.blend_mode == BLEND_MODE_ALPHA ? VK_TRUE : VK_FALSE,
 		.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA,
 		.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA,
 		.colorBlendOp = VK_BLEND_OP_ADD,
@@ -160,35 +268,16 @@ bool create_default_pipeline() {
 		.blendConstants = { 0.0f, 0.0f, 0.0f, 0.0f }
 	};
 
-	VkPushConstantRange ranges[] = {
-		{
-			.stageFlags = VK_SHADER_STAGE_VERTEX_BIT,
-			.offset = 0,
-			.size = 64 // 4 by 4 matrix with 4 bytes per float
-		},
-		{
-			.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT,
-			.offset = 64,
-			.size = sizeof(int)
-		}
+	// NOTE: no render pass, pipelines are used inside dynamic rendering that draws to the swapchain format
+	VkPipelineRenderingCreateInfo rendering_info = {
+		.sType = VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO,
+		.colorAttachmentCount = 1,
+		.pColorAttachmentFormats = &c.swapchain_image_format,
 	};
 
-	VkPipelineLayoutCreateInfo pipeline_layout_info = {
-		.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
-		.setLayoutCount = 1,
-		.pSetLayouts = &c.descriptor_set_layout,
-		.pushConstantRangeCount = 2,
-		.pPushConstantRanges = ranges
-	};
-
-	VkResult result = vkCreatePipelineLayout(c.device, &pipeline_layout_info, 0, &c.pipeline_layout[0]);
-	if (result != VK_SUCCESS) {
-		platform_log("Fatal: Failed to create pipeline layout!\n");
-		return false;
-	}
-
 	VkGraphicsPipelineCreateInfo pipeline_info = {
 		.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
+		.pNext = &rendering_info,
 		.stageCount = 2,
 		.pStages = shader_stage_create_infos,
 		.pVertexInputState = &vertex_input_info,
@@ -198,170 +287,220 @@ bool create_default_pipeline() {
 		.pMultisampleState = &multisampling,
 		.pColorBlendState = &color_blending,
 		.pDynamicState = &dynamic_state_info,
-		.layout = c.pipeline_layout[0],
-		.renderPass = c.main_pass,
-		.subpass = 0
+		.layout = c.pipeline_layout,
 	};
 
-	result = vkCreateGraphicsPipelines(c.device, VK_NULL_HANDLE, 1, &pipeline_info, 0, &c.graphics_pipeline[0]);
-	if (result != VK_SUCCESS) {
-		platform_log("Fatal: Failed to create graphics pipelines!\n");
-		return false;
-	}
-
-	vkDestroyShaderModule(c.device, vertex_shader_module, 0);
-	vkDestroyShaderModule(c.device, fragment_shader_module, 0);
-
-	return true;
+	// NOTE: the pipeline cache is internally synchronized, so all jobs can share it
+	job->result = vkCreateGraphicsPipelines(c.device, c.pipeline_cache, 1, &pipeline_info, 0, &job->pipeline);
 }
 
-bool create_font_pipeline() {
-	VkShaderModule font_vs_module = {};
-	bool shader_created = create_shader_module("res/shaders/font_vs.spv", &font_vs_module);
-	if (!shader_created) {
-		platform_log("Fatal: Failed to create the font vertex shader module!\n");
-		return GAME_FAILURE;
-	}
+//
+// EXTERNAL
+//
+
+bool create_pipeline_cache(const char *file_path) {
+	Pipeline_Cache_File_Header expected = get_pipeline_cache_header();
 
-	VkPipelineShaderStageCreateInfo font_vs_stage_info = {
-		.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
-		.stage = VK_SHADER_STAGE_VERTEX_BIT,
-		.module = font_vs_module,
-		.pName = "main"
+	VkPipelineCacheCreateInfo cache_info = {
+		.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO,
 	};
 
-	VkShaderModule font_fs_module = {};
-	shader_created = create_shader_module("res/shaders/font_fs.spv", &font_fs_module);
-	if (!shader_created) {
-		platform_log("Fatal: Failed to create the font fragment shader module!\n");
-		return GAME_FAILURE;
+	// a missing or stale file is not an error, we just start with an empty cache
+	File_Asset file_asset = {};
+	uint32 size = platform_read_file(file_path, &file_asset);
+	if (size >= sizeof(Pipeline_Cache_File_Header)) {
+		Pipeline_Cache_File_Header header;
+		memcpy(&header, file_asset.data, sizeof(header));
+		const char *data = file_asset.data + sizeof(header);
+
+		bool valid = header.magic == expected.magic &&
+			header.vendor_id == expected.vendor_id &&
+			header.device_id == expected.device_id &&
+			header.driver_version == expected.driver_version &&
+			memcmp(header.uuid, expected.uuid, VK_UUID_SIZE) == 0 &&
+			header.data_size == size - sizeof(header) &&
+			header.data_hash == hash_bytes(data, header.data_size);
+		if (valid) {
+			cache_info.initialDataSize = header.data_size;
+			cache_info.pInitialData = data;
+		}
+		else {
+			platform_log("Pipeline cache '%s' does not match this device or driver, rebuilding it.\n", file_path);
+		}
 	}
 
-	VkPipelineShaderStageCreateInfo font_fs_stage_info = {
-		.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
-		.stage = VK_SHADER_STAGE_FRAGMENT_BIT,
-		.module = font_fs_module,
-		.pName = "main"
-	};
-
-	VkPipelineShaderStageCreateInfo shader_stage_create_infos[] = { font_vs_stage_info, font_fs_stage_info };
+	VkResult result = vkCreatePipelineCache(c.device, &cache_info, 0, &c.pipeline_cache);
+	if (size > 0) {
+		platform_free_file(&file_asset);
+	}
+	if (result != VK_SUCCESS) {
+		return false;
+	}
 
-	VkDynamicState dynamic_states[] = { VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR };
-	VkPipelineDynamicStateCreateInfo dynamic_state_info = {
-		.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO,
-		.dynamicStateCount = sizeof(shader_stage_create_infos) / sizeof(shader_stage_create_infos[0]),
-		.pDynamicStates = dynamic_states
-	};
+	return true;
+}
 
-	VkPipelineInputAssemblyStateCreateInfo input_assembly_info = {
-		.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO,
-		.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST,
-		.primitiveRestartEnable = VK_FALSE
-	};
+void save_pipeline_cache(const char *file_path) {
+	if (c.pipeline_cache == VK_NULL_HANDLE) return;
+
+	size_t data_size = 0;
+	VkResult result = vkGetPipelineCacheData(c.device, c.pipeline_cache, &data_size, 0);
+	if (result != VK_SUCCESS || data_size == 0) return;
+
+	char *file_data = new char[sizeof(Pipeline_Cache_File_Header) + data_size];
+	char *data = file_data + sizeof(Pipeline_Cache_File_Header);
+	result = vkGetPipelineCacheData(c.device, c.pipeline_cache, &data_size, data);
+	if (result == VK_SUCCESS) {
+		Pipeline_Cache_File_Header header = get_pipeline_cache_header();
+		header.data_size = static_cast<uint32>(data_size);
+		header.data_hash = hash_bytes(data, data_size);
+		memcpy(file_data, &header, sizeof(header));
+
+		bool written = platform_write_file(file_path, file_data, static_cast<uint32>(sizeof(header) + data_size));
+		if (!written) {
+			platform_log("Failed to write the pipeline cache to '%s'!\n", file_path);
+		}
+	}
 
-	// NOTE: we are using dynamic state, so we need to specify viewport and scissor at drawing time, instead of here
+	delete[] file_data;
+}
 
-	VkPipelineViewportStateCreateInfo viewport_info = {
-		.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO,
-		.viewportCount = 1,
-		//.pViewports = &viewport,
-		.scissorCount = 1,
-		//.pScissors = &scissors
-	};
+void destroy_pipeline_cache() {
+	vkDestroyPipelineCache(c.device, c.pipeline_cache, 0);
+	c.pipeline_cache = VK_NULL_HANDLE;
+}
 
-	VkPipelineRasterizationStateCreateInfo rasterization_info = {
-		.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO,
-		.depthClampEnable = VK_FALSE,
-		.rasterizerDiscardEnable = VK_FALSE,
-		.polygonMode = VK_POLYGON_MODE_FILL,
-		.cullMode = VK_CULL_MODE_BACK_BIT,
-		.frontFace = VK_FRONT_FACE_CLOCKWISE,
-		.depthBiasEnable = VK_FALSE,
-		.lineWidth = 1.0f
-	};
+uint64 hash_pipeline_description(const Pipeline_Description &description) {
+	// NOTE: hashed field by field, the struct has padding
+	// the shader paths with their terminating zero, so "ab" "c" and "a" "bc" differ
+	uint64 hash = hash_bytes(description.vertex_shader, strlen(description.vertex_shader) + 1);
+	hash = hash_bytes(description.fragment_shader, strlen(description.fragment_shader) + 1, hash);
+	hash = hash_bytes(&description.vertex_layout, sizeof(description.vertex_layout), hash);
+	hash = hash_bytes(&description.topology, sizeof(description.topology), hash);
+	hash = hash_bytes(&description.polygon_mode, sizeof(description.polygon_mode), hash);
+	hash = hash_bytes(&description.cull_mode, sizeof(description.cull_mode), hash);
+	hash = hash_bytes(&description.front_face, sizeof(description.front_face), hash);
+	hash = hash_bytes(&description.blend_mode, sizeof(description.blend_mode), hash);
+	return hash;
+}
 
-	VkPipelineMultisampleStateCreateInfo multisampling = {
-		.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO,
-		.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT,
-		.sampleShadingEnable = VK_FALSE
-	};
+bool create_pipelines() {
+	//
+	// one layout for every pipeline, that way descriptor sets and push constants stay valid across pipeline binds
+	//
+	{
+		VkPushConstantRange push_constant_range = {
+			.stageFlags = PUSH_CONSTANT_STAGES,
+			.offset = 0,
+			.size = PUSH_CONSTANT_SIZE,
+		};
+
+		// set 0 holds the per frame uniforms, set 1 the bindless textures
+		VkDescriptorSetLayout set_layouts[] = { c.descriptor_set_layout, c.bindless_set_layout };
+		VkPipelineLayoutCreateInfo pipeline_layout_info = {
+			.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+			.setLayoutCount = sizeof(set_layouts) / sizeof(set_layouts[0]),
+			.pSetLayouts = set_layouts,
+			.pushConstantRangeCount = 1,
+			.pPushConstantRanges = &push_constant_range
+		};
+
+		VkResult result = vkCreatePipelineLayout(c.device, &pipeline_layout_info, 0, &c.pipeline_layout);
+		if (result != VK_SUCCESS) {
+			platform_log("Fatal: Failed to create pipeline layout!\n");
+			return false;
+		}
+	}
 
-	VkPipelineColorBlendAttachmentState color_blend_attachment = {
-		.blendEnable = VK_TRUE,
-		.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA,
-		.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA,
-		.colorBlendOp = VK_BLEND_OP_ADD,
-		.srcAlphaBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA,
-		.dstAlphaBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA,
-		.alphaBlendOp = VK_BLEND_OP_ADD,
-		.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT
-	};
+	//
+	// dedup the table: equal descriptions share one pipeline
+	//
+	uint32 unique_index[PIPELINE_COUNT];
+	uint64 description_hashes[PIPELINE_COUNT];
+	Pipeline_Compile_Job jobs[PIPELINE_COUNT] = {};
+	uint32 job_count = 0;
+
+	for (uint32 i = 0; i < PIPELINE_COUNT; ++i) {
+		description_hashes[i] = hash_pipeline_description(pipeline_descriptions[i]);
+
+		unique_index[i] = job_count;
+		for (uint32 j = 0; j < i; ++j) {
+			if (description_hashes[j] == description_hashes[i] && pipeline_descriptions_equal(pipeline_descriptions[j], pipeline_descriptions[i])) {
+				unique_index[i] = unique_index[j];
+				break;
+			}
+		}
+		if (unique_index[i] != job_count) continue;
 
-	VkPipelineColorBlendStateCreateInfo color_blending = {
-		.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO,
-		.logicOpEnable = VK_FALSE,
-		.logicOp = VK_LOGIC_OP_COPY,
-		.attachmentCount = 1,
-		.pAttachments = &color_blend_attachment,
-		.blendConstants = { 0.0f, 0.0f, 0.0f, 0.0f }
-	};
+		jobs[job_count++].description = &pipeline_descriptions[i];
+	}
 
-	VkPushConstantRange ranges[] = {
-		{
-			.stageFlags = VK_SHADER_STAGE_VERTEX_BIT,
-			.offset = 0,
-			.size = 64 // 4 by 4 matrix with 4 bytes per float
-		},
-		{
-			.stageFlags = VK_SHADER_STAGE_VERTEX_BIT,
-			.offset = 64,
-			.size = 8
-		},
-		{
-			.stageFlags = VK_SHADER_STAGE_VERTEX_BIT,
-			.offset = 72,
-			.size = 8
+	//
+	// load every shader once
+	//
+	std::vector<const char *> shader_paths;
+	std::vector<VkShaderModule> shader_modules;
+	auto get_shader_module = [&](const char *path, VkShaderModule *shader_module) -> bool {
+		for (size_t i = 0; i < shader_paths.size(); ++i) {
+			if (strcmp(shader_paths[i], path) == 0) {
+				*shader_module = shader_modules[i];
+				return true;
+			}
 		}
+		if (!create_shader_module(path, shader_module)) {
+			platform_log("Fatal: Failed to create the shader module '%s'!\n", path);
+			return false;
+		}
+		shader_paths.push_back(path);
+		shader_modules.push_back(*shader_module);
+		return true;
 	};
 
-	VkPipelineLayoutCreateInfo pipeline_layout_info = {
-		.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
-		.setLayoutCount = 1,
-		.pSetLayouts = &c.descriptor_set_layout,
-		.pushConstantRangeCount = 3,
-		.pPushConstantRanges = ranges
-	};
-
-	VkResult result = vkCreatePipelineLayout(c.device, &pipeline_layout_info, 0, &c.pipeline_layout[1]);
-	if (result != VK_SUCCESS) {
-		platform_log("Fatal: Failed to create pipeline layout!\n");
-		return false;
+	bool result = true;
+	for (uint32 i = 0; i < job_count && result; ++i) {
+		result = get_shader_module(jobs[i].description->vertex_shader, &jobs[i].vertex_module) &&
+			get_shader_module(jobs[i].description->fragment_shader, &jobs[i].fragment_module);
 	}
 
-	VkGraphicsPipelineCreateInfo pipeline_info = {
-		.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
-		.stageCount = 2,
-		.pStages = shader_stage_create_infos,
-		.pVertexInputState = NULL,
-		.pInputAssemblyState = &input_assembly_info,
-		.pViewportState = &viewport_info,
-		.pRasterizationState = &rasterization_info,
-		.pMultisampleState = &multisampling,
-		.pColorBlendState = &color_blending,
-		.pDynamicState = &dynamic_state_info,
-		.layout = c.pipeline_layout[1],
-		.renderPass = c.main_pass,
-		.subpass = 0
-	};
+	//
+	// compile all pipelines at once
+	//
+	if (result) {
+		Job_Counter counter = {};
+		for (uint32 i = 0; i < job_count; ++i) {
+			jobs_submit(compile_pipeline_job, &jobs[i], &counter);
+		}
+		jobs_wait(&counter);
+	}
 
-	result = vkCreateGraphicsPipelines(c.device, VK_NULL_HANDLE, 1, &pipeline_info, 0, &c.graphics_pipeline[1]);
-	if (result != VK_SUCCESS) {
-		platform_log("Fatal: Failed to create graphics pipelines!\n");
+	for (VkShaderModule shader_module : shader_modules) {
+		vkDestroyShaderModule(c.device, shader_module, 0);
+	}
+	if (!result) {
 		return false;
 	}
 
-	vkDestroyShaderModule(c.device, font_vs_module, 0);
-	vkDestroyShaderModule(c.device, font_fs_module, 0);
+	for (uint32 i = 0; i < job_count; ++i) {
+		if (jobs[i].result != VK_SUCCESS) {
+			platform_log("Fatal: Failed to create graphics pipelines!\n");
+			return false;
+		}
+		unique_pipelines.push_back(jobs[i].pipeline);
+	}
+
+	for (uint32 i = 0; i < PIPELINE_COUNT; ++i) {
+		c.graphics_pipeline[i] = jobs[unique_index[i]].pipeline;
+	}
 
 	return true;
 }
+
+void destroy_pipelines() {
+	for (VkPipeline pipeline : unique_pipelines) {
+		vkDestroyPipeline(c.device, pipeline, 0);
+	}
+	unique_pipelines.clear();
+
+	vkDestroyPipelineLayout(c.device, c.pipeline_layout, 0);
+	c.pipeline_layout = VK_NULL_HANDLE;
+}
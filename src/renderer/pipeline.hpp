@@ -1,9 +1,57 @@
 #ifndef PIPELINE_H
 #define PIPELINE_H
 
+#include "types.hpp"
+
 #include <vulkan/vulkan.h>
 
-bool create_default_pipeline();
-bool create_font_pipeline();
+enum Pipeline_Id {
+	PIPELINE_DEFAULT = 0,
+	PIPELINE_FONT    = 1,
+	PIPELINE_SPRITE  = 2,
+	PIPELINE_COUNT   = 3,
+};
+
+enum Vertex_Layout {
+	VERTEX_LAYOUT_NONE           = 0, // vertices come from push constants or buffers the shader reads itself
+	VERTEX_LAYOUT_DEFAULT        = 1, // Vertex from assets.hpp
+	VERTEX_LAYOUT_GLYPH_INSTANCE = 2, // Glyph_Instance from fonts.hpp, one per instance
+	VERTEX_LAYOUT_SPRITE_INSTANCE = 3, // Sprite_Instance from sprites.hpp, one per instance
+};
+
+enum Blend_Mode {
+	BLEND_MODE_OPAQUE = 0,
+	BLEND_MODE_ALPHA  = 1,
+};
+
+// NOTE: all pipelines share one layout with a single push constant block visible to every stage (128 bytes is
+// the guaranteed minimum), so pushes always use PUSH_CONSTANT_STAGES and shaders declare the part they read
+constexpr uint32 PUSH_CONSTANT_SIZE = 128;
+constexpr VkShaderStageFlags PUSH_CONSTANT_STAGES = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
+
+// NOTE: everything a pipeline entry doesn't set keeps the defaults below, so a new pipeline or shader
+// variant is one more entry in the pipeline table in pipeline.cpp. Equal entries get compiled once.
+struct Pipeline_Description {
+	const char *vertex_shader;
+	const char *fragment_shader;
+	Vertex_Layout vertex_layout = VERTEX_LAYOUT_DEFAULT;
+	VkPrimitiveTopology topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+	VkPolygonMode polygon_mode = VK_POLYGON_MODE_FILL;
+	VkCullModeFlags cull_mode = VK_CULL_MODE_BACK_BIT;
+	VkFrontFace front_face = VK_FRONT_FACE_CLOCKWISE;
+	Blend_Mode blend_mode = BLEND_MODE_ALPHA;
+};
+
+constexpr const char *PIPELINE_CACHE_FILE_PATH = "pipeline_cache.bin";
+
+bool create_pipeline_cache(const char *file_path);
+void save_pipeline_cache(const char *file_path);
+void destroy_pipeline_cache();
+
+uint64 hash_pipeline_description(const Pipeline_Description &description);
+
+// compiles every entry of the pipeline table on the job system and waits for all of them
+bool create_pipelines();
+void destroy_pipelines();
 
 #endif
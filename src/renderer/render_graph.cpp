@@ -0,0 +1,605 @@
+#include "render_graph.hpp"
+
+#include "platform.hpp"
+#include "renderer/vulkan_init.hpp"
+#include "renderer/vulkan_memory.hpp"
+#include "renderer/gpu_profiler.hpp"
+
+#include <vulkan/vulkan.h>
+
+#include <algorithm>
+#include <vector>
+
+//
+// Internal
+//
+
+struct Resource_Usage {
+	Render_Resource resource;
+	Render_Access access;
+	bool write;
+	bool clear;
+	VkClearValue clear_value;
+};
+
+struct Graph_Pass {
+	const char *name;
+	Render_Pass_Callback callback;
+	void *user_data;
+	uint32 flags;
+	std::vector<Resource_Usage> usages;
+	bool culled;
+};
+
+struct Resource_State {
+	VkImageLayout layout;
+	VkPipelineStageFlags2 stage;
+	VkAccessFlags2 access;
+	bool written; // the accesses since the last barrier include a write
+};
+
+struct Graph_Resource {
+	bool imported;
+	Render_Image_Description description;
+	VkImage image;
+	VkImageView image_view;
+	VkImageLayout final_layout; // imported only
+
+	// filled in by compile, indices are into the executed passes
+	uint32 first_pass;
+	uint32 last_pass;
+	uint32 slot; // transient only
+
+	Resource_State state;
+};
+
+// a piece of device memory that transient images with disjoint lifetimes take turns in
+struct Memory_Slot {
+	Memory_Allocation memory;
+	VkMemoryRequirements requirements;
+	Resource_State state; // of the last image that used it this frame, the next one waits on that
+};
+
+struct Physical_Image {
+	Render_Image_Description description;
+	uint32 slot;
+	VkImage image;
+	VkImageView image_view;
+	bool used;
+};
+
+// NOTE: transient memory can't be shared between frames in flight, so each frame has its own slots and images.
+// render_graph_begin runs after the frame's fence was waited on, so anything in here is free to reuse.
+struct Frame_Resources {
+	std::vector<Memory_Slot> slots;
+	std::vector<Physical_Image> images;
+};
+
+struct Render_Graph {
+	std::vector<Graph_Pass> passes;
+	std::vector<Graph_Resource> resources;
+	std::vector<uint32> execution_order;
+	Frame_Resources frames[MAX_FRAMES_IN_FLIGHT];
+	bool compiled;
+};
+
+global_variable Render_Graph graph;
+
+struct Access_Info {
+	VkImageLayout layout;
+	VkPipelineStageFlags2 stage;
+	VkAccessFlags2 access;
+	VkImageUsageFlags usage;
+};
+
+global_variable const Access_Info access_infos[RENDER_ACCESS_COUNT] = {
+	// RENDER_ACCESS_COLOR_ATTACHMENT
+	{ VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT, VK_ACCESS_2_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT },
+	// RENDER_ACCESS_SAMPLED
+	{ VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT, VK_ACCESS_2_SHADER_SAMPLED_READ_BIT, VK_IMAGE_USAGE_SAMPLED_BIT },
+	// RENDER_ACCESS_TRANSFER_SRC
+	{ VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_PIPELINE_STAGE_2_ALL_TRANSFER_BIT, VK_ACCESS_2_TRANSFER_READ_BIT, VK_IMAGE_USAGE_TRANSFER_SRC_BIT },
+	// RENDER_ACCESS_TRANSFER_DST
+	{ VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_PIPELINE_STAGE_2_ALL_TRANSFER_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT, VK_IMAGE_USAGE_TRANSFER_DST_BIT },
+};
+
+internal_function bool descriptions_equal(const Render_Image_Description &a, const Render_Image_Description &b) {
+	return a.format == b.format && a.extent.width == b.extent.width && a.extent.height == b.extent.height && a.usage == b.usage;
+}
+
+internal_function VkImageCreateInfo get_image_info(const Render_Image_Description &description) {
+	VkImageCreateInfo image_info = {
+		.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
+		.imageType = VK_IMAGE_TYPE_2D,
+		.format = description.format,
+		.extent = { description.extent.width, description.extent.height, 1 },
+		.mipLevels = 1,
+		.arrayLayers = 1,
+		.samples = VK_SAMPLE_COUNT_1_BIT,
+		.tiling = VK_IMAGE_TILING_OPTIMAL,
+		.usage = description.usage,
+		.sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+		.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+	};
+	return image_info;
+}
+
+internal_function void destroy_physical_image(Physical_Image *image) {
+	vkDestroyImageView(c.device, image->image_view, 0);
+	vkDestroyImage(c.device, image->image, 0);
+}
+
+internal_function void add_usage(Render_Pass pass, Render_Resource resource, Render_Access access, bool write, const VkClearValue *clear_value) {
+	Resource_Usage usage = {
+		.resource = resource,
+		.access = access,
+		.write = write,
+		.clear = clear_value != 0,
+	};
+	if (clear_value) usage.clear_value = *clear_value;
+	graph.passes[pass].usages.push_back(usage);
+	graph.compiled = false;
+}
+
+internal_function void cull_passes() {
+	// walk backwards: a pass survives if it has side effects, writes an imported image or writes something a
+	// surviving pass needs; what a surviving pass reads (or loads) is needed in turn
+	std::vector<bool> needed(graph.resources.size(), false);
+
+	for (size_t p = graph.passes.size(); p-- > 0;) {
+		Graph_Pass &pass = graph.passes[p];
+
+		bool keep = (pass.flags & RENDER_PASS_SIDE_EFFECTS) != 0;
+		for (const Resource_Usage &usage : pass.usages) {
+			if (usage.write && (graph.resources[usage.resource].imported || needed[usage.resource])) {
+				keep = true;
+			}
+		}
+
+		pass.culled = !keep;
+		if (pass.culled) continue;
+
+		for (const Resource_Usage &usage : pass.usages) {
+			// a write that doesn't clear keeps the old contents, so whoever wrote them before is needed
+			if (!usage.write || !usage.clear) {
+				needed[usage.resource] = true;
+			}
+			else {
+				needed[usage.resource] = false;
+			}
+		}
+	}
+}
+
+internal_function bool place_transient_images() {
+	Frame_Resources &frame = graph.frames[c.current_frame];
+
+	for (Physical_Image &image : frame.images) {
+		image.used = false;
+	}
+
+	//
+	// lifetimes of every resource over the executed passes
+	//
+	for (Graph_Resource &resource : graph.resources) {
+		resource.first_pass = 0xFFFFFFFF;
+		resource.last_pass = 0;
+	}
+	for (uint32 i = 0; i < graph.execution_order.size(); ++i) {
+		for (const Resource_Usage &usage : graph.passes[graph.execution_order[i]].usages) {
+			Graph_Resource &resource = graph.resources[usage.resource];
+			if (resource.first_pass == 0xFFFFFFFF) resource.first_pass = i;
+			resource.last_pass = i;
+			if (!resource.imported) {
+				resource.description.usage |= access_infos[usage.access].usage;
+			}
+		}
+	}
+
+	std::vector<uint32> transients;
+	for (uint32 i = 0; i < graph.resources.size(); ++i) {
+		if (!graph.resources[i].imported && graph.resources[i].first_pass != 0xFFFFFFFF) transients.push_back(i);
+	}
+	std::sort(transients.begin(), transients.end(), [](uint32 a, uint32 b) { return graph.resources[a].first_pass < graph.resources[b].first_pass; });
+
+	//
+	// greedy interval coloring: a transient goes into the first slot whose current owner is dead by the time it
+	// starts and whose memory type works for it, the slot grows to fit everything that lands in it
+	//
+	struct Virtual_Slot {
+		VkMemoryRequirements requirements;
+		uint32 busy_until;
+	};
+	std::vector<Virtual_Slot> virtual_slots;
+
+	for (uint32 index : transients) {
+		Graph_Resource &resource = graph.resources[index];
+
+		VkImageCreateInfo image_info = get_image_info(resource.description);
+		VkDeviceImageMemoryRequirements requirements_info = {
+			.sType = VK_STRUCTURE_TYPE_DEVICE_IMAGE_MEMORY_REQUIREMENTS,
+			.pCreateInfo = &image_info,
+		};
+		VkMemoryRequirements2 requirements2 = {
+			.sType = VK_STRUCTURE_TYPE_MEMORY_REQUIREMENTS_2,
+		};
+		vkGetDeviceImageMemoryRequirements(c.device, &requirements_info, &requirements2);
+		VkMemoryRequirements requirements = requirements2.memoryRequirements;
+
+		resource.slot = 0xFFFFFFFF;
+		for (uint32 s = 0; s < virtual_slots.size(); ++s) {
+			Virtual_Slot &slot = virtual_slots[s];
+			if (slot.busy_until < resource.first_pass && (slot.requirements.memoryTypeBits & requirements.memoryTypeBits)) {
+				slot.requirements.size = std::max(slot.requirements.size, requirements.size);
+				slot.requirements.alignment = std::max(slot.requirements.alignment, requirements.alignment);
+				slot.requirements.memoryTypeBits &= requirements.memoryTypeBits;
+				slot.busy_until = resource.last_pass;
+				resource.slot = s;
+				break;
+			}
+		}
+		if (resource.slot == 0xFFFFFFFF) {
+			resource.slot = static_cast<uint32>(virtual_slots.size());
+			virtual_slots.push_back({ requirements, resource.last_pass });
+		}
+	}
+
+	//
+	// make the frame's real slots match, reallocating the ones that are too small or of the wrong type
+	//
+	if (frame.slots.size() < virtual_slots.size()) {
+		frame.slots.resize(virtual_slots.size(), Memory_Slot{});
+	}
+	for (uint32 s = 0; s < virtual_slots.size(); ++s) {
+		Memory_Slot &slot = frame.slots[s];
+		const VkMemoryRequirements &needed = virtual_slots[s].requirements;
+
+		bool fits = slot.memory.memory != VK_NULL_HANDLE &&
+			slot.memory.size >= needed.size &&
+			(slot.memory.offset % needed.alignment) == 0 &&
+			(needed.memoryTypeBits & (1u << slot.memory.memory_type_index));
+		if (!fits) {
+			// images bound to the old memory go with it
+			for (size_t i = 0; i < frame.images.size();) {
+				if (frame.images[i].slot == s) {
+					destroy_physical_image(&frame.images[i]);
+					frame.images[i] = frame.images.back();
+					frame.images.pop_back();
+				}
+				else {
+					++i;
+				}
+			}
+			if (slot.memory.memory != VK_NULL_HANDLE) free_memory(&slot.memory);
+
+			bool result = allocate_memory(needed, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, MEMORY_RESOURCE_OPTIMAL, &slot.memory);
+			if (!result) {
+				platform_log("Fatal: Failed to allocate memory for transient render graph images!\n");
+				return false;
+			}
+			slot.requirements = needed;
+		}
+		slot.state = { VK_IMAGE_LAYOUT_UNDEFINED, VK_PIPELINE_STAGE_2_NONE, VK_ACCESS_2_NONE, false };
+	}
+
+	//
+	// find or create the images
+	//
+	for (uint32 index : transients) {
+		Graph_Resource &resource = graph.resources[index];
+
+		Physical_Image *physical = 0;
+		for (Physical_Image &image : frame.images) {
+			if (!image.used && image.slot == resource.slot && descriptions_equal(image.description, resource.description)) {
+				physical = &image;
+				break;
+			}
+		}
+
+		if (!physical) {
+			Physical_Image image = { resource.description, resource.slot };
+
+			VkImageCreateInfo image_info = get_image_info(resource.description);
+			VkResult result = vkCreateImage(c.device, &image_info, 0, &image.image);
+			if (result != VK_SUCCESS) {
+				platform_log("Fatal: Failed to create a transient render graph image!\n");
+				return false;
+			}
+
+			const Memory_Allocation &memory = frame.slots[resource.slot].memory;
+			vkBindImageMemory(c.device, image.image, memory.memory, memory.offset);
+
+			VkImageViewCreateInfo view_info = {
+				.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
+				.image = image.image,
+				.viewType = VK_IMAGE_VIEW_TYPE_2D,
+				.format = resource.description.format,
+				.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 },
+			};
+			result = vkCreateImageView(c.device, &view_info, 0, &image.image_view);
+			if (result != VK_SUCCESS) {
+				vkDestroyImage(c.device, image.image, 0);
+				platform_log("Fatal: Failed to create a transient render graph image view!\n");
+				return false;
+			}
+
+			frame.images.push_back(image);
+			physical = &frame.images.back();
+		}
+
+		physical->used = true;
+		resource.image = physical->image;
+		resource.image_view = physical->image_view;
+	}
+
+	// whatever this frame didn't need anymore (resized, pass removed) goes away
+	for (size_t i = 0; i < frame.images.size();) {
+		if (!frame.images[i].used) {
+			destroy_physical_image(&frame.images[i]);
+			frame.images[i] = frame.images.back();
+			frame.images.pop_back();
+		}
+		else {
+			++i;
+		}
+	}
+
+	return true;
+}
+
+//
+// Exported
+//
+
+bool render_graph_init() {
+	graph = {};
+	return true;
+}
+
+void render_graph_shutdown() {
+	for (Frame_Resources &frame : graph.frames) {
+		for (Physical_Image &image : frame.images) {
+			destroy_physical_image(&image);
+		}
+		for (Memory_Slot &slot : frame.slots) {
+			if (slot.memory.memory != VK_NULL_HANDLE) free_memory(&slot.memory);
+		}
+		frame.images.clear();
+		frame.slots.clear();
+	}
+	graph.passes.clear();
+	graph.resources.clear();
+}
+
+void render_graph_begin() {
+	graph.passes.clear();
+	graph.resources.clear();
+	graph.execution_order.clear();
+	graph.compiled = false;
+}
+
+Render_Resource render_graph_import_image(VkImage image, VkImageView image_view, VkFormat format, VkExtent2D extent, VkImageLayout final_layout, VkImageLayout initial_layout) {
+	Graph_Resource resource = {
+		.imported = true,
+		.description = { format, extent, 0 },
+		.image = image,
+		.image_view = image_view,
+		.final_layout = final_layout,
+		// NOTE: undefined images come out of vkAcquireNextImageKHR, whose semaphore the frame waits on at the
+		// color attachment output stage; starting the first barrier there chains with that wait. Anything else
+		// was used by earlier frames in who knows which stage, so the first barrier waits for all of it.
+		.state = { initial_layout, initial_layout == VK_IMAGE_LAYOUT_UNDEFINED ? VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT : VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, VK_ACCESS_2_NONE, false },
+	};
+	graph.resources.push_back(resource);
+	return static_cast<Render_Resource>(graph.resources.size() - 1);
+}
+
+Render_Resource render_graph_create_image(const Render_Image_Description &description) {
+	Graph_Resource resource = {
+		.imported = false,
+		.description = description,
+	};
+	graph.resources.push_back(resource);
+	return static_cast<Render_Resource>(graph.resources.size() - 1);
+}
+
+Render_Pass render_graph_add_pass(const char *name, Render_Pass_Callback callback, void *user_data, uint32 flags) {
+	Graph_Pass pass = {
+		.name = name,
+		.callback = callback,
+		.user_data = user_data,
+		.flags = flags,
+	};
+	graph.passes.push_back(pass);
+	graph.compiled = false;
+	return static_cast<Render_Pass>(graph.passes.size() - 1);
+}
+
+void render_graph_write_color(Render_Pass pass, Render_Resource resource, const VkClearValue *clear_value) {
+	add_usage(pass, resource, RENDER_ACCESS_COLOR_ATTACHMENT, true, clear_value);
+}
+
+void render_graph_read(Render_Pass pass, Render_Resource resource, Render_Access access) {
+	add_usage(pass, resource, access, false, 0);
+}
+
+void render_graph_write(Render_Pass pass, Render_Resource resource, Render_Access access) {
+	add_usage(pass, resource, access, true, 0);
+}
+
+bool render_graph_compile() {
+	cull_passes();
+
+	// NOTE: a pass can only use what was declared before it, so every dependency points backwards and the
+	// order passes were added in already is a valid topological order; culling only removes passes from it
+	graph.execution_order.clear();
+	for (uint32 i = 0; i < graph.passes.size(); ++i) {
+		if (!graph.passes[i].culled) graph.execution_order.push_back(i);
+	}
+
+	bool result = place_transient_images();
+	if (!result) return false;
+
+	graph.compiled = true;
+	return true;
+}
+
+void render_graph_execute(VkCommandBuffer command_buffer) {
+	if (!graph.compiled) {
+		platform_log("Fatal: The render graph has to be compiled before it is executed!\n");
+		return;
+	}
+
+	Frame_Resources &frame = graph.frames[c.current_frame];
+	std::vector<VkImageMemoryBarrier2> barriers;
+	std::vector<VkRenderingAttachmentInfo> color_attachments;
+
+	for (uint32 execution_index = 0; execution_index < graph.execution_order.size(); ++execution_index) {
+		Graph_Pass &pass = graph.passes[graph.execution_order[execution_index]];
+
+		// the pass' gpu time includes its barriers
+		uint32 gpu_scope = gpu_profiler_begin_scope(command_buffer, pass.name);
+
+		//
+		// barriers
+		//
+		barriers.clear();
+		for (const Resource_Usage &usage : pass.usages) {
+			Graph_Resource &resource = graph.resources[usage.resource];
+			const Access_Info &info = access_infos[usage.access];
+
+			Resource_State previous = resource.state;
+			if (!resource.imported && resource.first_pass == execution_index) {
+				// first use of a transient, it takes over the memory from whoever had the slot before
+				previous = frame.slots[resource.slot].state;
+				previous.layout = VK_IMAGE_LAYOUT_UNDEFINED;
+			}
+
+			// read after read in the same layout needs nothing, everything else does
+			bool needs_barrier = previous.layout != info.layout || previous.written || usage.write;
+			if (!needs_barrier) {
+				resource.state.stage |= info.stage;
+				resource.state.access |= info.access;
+				continue;
+			}
+
+			VkAccessFlags2 dst_access = info.access;
+			if (usage.access == RENDER_ACCESS_COLOR_ATTACHMENT && usage.clear) dst_access &= ~VK_ACCESS_2_COLOR_ATTACHMENT_READ_BIT;
+
+			VkImageMemoryBarrier2 barrier = {
+				.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2,
+				.srcStageMask = previous.stage,
+				.srcAccessMask = previous.written ? previous.access : VK_ACCESS_2_NONE, // only writes have to be made available
+				.dstStageMask = info.stage,
+				.dstAccessMask = dst_access,
+				.oldLayout = usage.clear ? VK_IMAGE_LAYOUT_UNDEFINED : previous.layout, // cleared anyway, no need to keep the contents
+				.newLayout = info.layout,
+				.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+				.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+				.image = resource.image,
+				.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 },
+			};
+			barriers.push_back(barrier);
+
+			resource.state = { info.layout, info.stage, dst_access, usage.write };
+		}
+
+		if (!barriers.empty()) {
+			VkDependencyInfo dependency_info = {
+				.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
+				.imageMemoryBarrierCount = static_cast<uint32>(barriers.size()),
+				.pImageMemoryBarriers = barriers.data(),
+			};
+			vkCmdPipelineBarrier2(command_buffer, &dependency_info);
+		}
+
+		//
+		// the pass itself
+		//
+		bool rendering = !(pass.flags & RENDER_PASS_NO_RENDERING);
+		if (rendering) {
+			color_attachments.clear();
+			VkExtent2D extent = {};
+			for (const Resource_Usage &usage : pass.usages) {
+				if (usage.access != RENDER_ACCESS_COLOR_ATTACHMENT) continue;
+
+				Graph_Resource &resource = graph.resources[usage.resource];
+				VkRenderingAttachmentInfo attachment = {
+					.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO,
+					.imageView = resource.image_view,
+					.imageLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+					.loadOp = usage.clear ? VK_ATTACHMENT_LOAD_OP_CLEAR : VK_ATTACHMENT_LOAD_OP_LOAD,
+					.storeOp = VK_ATTACHMENT_STORE_OP_STORE,
+					.clearValue = usage.clear_value,
+				};
+				color_attachments.push_back(attachment);
+				extent = resource.description.extent;
+			}
+
+			VkRenderingInfo rendering_info = {
+				.sType = VK_STRUCTURE_TYPE_RENDERING_INFO,
+				.flags = (pass.flags & RENDER_PASS_SECONDARY_CONTENTS) ? VK_RENDERING_CONTENTS_SECONDARY_COMMAND_BUFFERS_BIT : 0u,
+				.renderArea = { {0, 0}, extent },
+				.layerCount = 1,
+				.colorAttachmentCount = static_cast<uint32>(color_attachments.size()),
+				.pColorAttachments = color_attachments.data(),
+			};
+			vkCmdBeginRendering(command_buffer, &rendering_info);
+		}
+
+		if (pass.callback) pass.callback(command_buffer, pass.user_data);
+
+		if (rendering) {
+			vkCmdEndRendering(command_buffer);
+		}
+
+		gpu_profiler_end_scope(command_buffer, gpu_scope);
+
+		// the memory slots remember how their current image was used last, the next image in them waits on that
+		for (const Resource_Usage &usage : pass.usages) {
+			Graph_Resource &resource = graph.resources[usage.resource];
+			if (!resource.imported) frame.slots[resource.slot].state = resource.state;
+		}
+	}
+
+	//
+	// hand imported images back in the layout their owner expects (present)
+	//
+	barriers.clear();
+	for (Graph_Resource &resource : graph.resources) {
+		if (!resource.imported || resource.first_pass == 0xFFFFFFFF) continue;
+		if (resource.state.layout == resource.final_layout && !resource.state.written) continue;
+
+		VkImageMemoryBarrier2 barrier = {
+			.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2,
+			.srcStageMask = resource.state.stage,
+			.srcAccessMask = resource.state.written ? resource.state.access : VK_ACCESS_2_NONE,
+			.dstStageMask = VK_PIPELINE_STAGE_2_NONE, // presentation waits on the semaphore, not on a stage
+			.dstAccessMask = VK_ACCESS_2_NONE,
+			.oldLayout = resource.state.layout,
+			.newLayout = resource.final_layout,
+			.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+			.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+			.image = resource.image,
+			.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 },
+		};
+		barriers.push_back(barrier);
+		resource.state = { resource.final_layout, VK_PIPELINE_STAGE_2_NONE, VK_ACCESS_2_NONE, false };
+	}
+	if (!barriers.empty()) {
+		VkDependencyInfo dependency_info = {
+			.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
+			.imageMemoryBarrierCount = static_cast<uint32>(barriers.size()),
+			.pImageMemoryBarriers = barriers.data(),
+		};
+		vkCmdPipelineBarrier2(command_buffer, &dependency_info);
+	}
+}
+
+VkImage render_graph_get_image(Render_Resource resource) {
+	return graph.resources[resource].image;
+}
+
+VkImageView render_graph_get_image_view(Render_Resource resource) {
+	return graph.resources[resource].image_view;
+}
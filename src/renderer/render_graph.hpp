@@ -0,0 +1,67 @@
+#ifndef RENDER_GRAPH_H
+#define RENDER_GRAPH_H
+
+#include "types.hpp"
+
+#include <vulkan/vulkan.h>
+
+// NOTE: the frame is described as a graph that is rebuilt every frame: passes declare which images they read
+// and write, compile derives the pass order, culls passes nobody consumes, places transient images into aliased
+// memory and execute records the passes with exactly the barriers and layout transitions they need
+// (synchronization2) around dynamic rendering. Nothing about the frame's synchronization is written by hand.
+
+typedef uint32 Render_Resource;
+typedef uint32 Render_Pass;
+
+constexpr uint32 INVALID_RENDER_RESOURCE = 0xFFFFFFFF;
+
+enum Render_Pass_Flags {
+	RENDER_PASS_FLAGS_NONE              = 0,
+	RENDER_PASS_SECONDARY_CONTENTS      = 1 << 0, // the callback only executes secondary command buffers
+	RENDER_PASS_NO_RENDERING            = 1 << 1, // transfer or compute work, no vkCmdBeginRendering around it
+	RENDER_PASS_SIDE_EFFECTS            = 1 << 2, // never culled, even if nobody reads what it writes
+};
+
+enum Render_Access {
+	RENDER_ACCESS_COLOR_ATTACHMENT = 0,
+	RENDER_ACCESS_SAMPLED          = 1, // read in a fragment shader
+	RENDER_ACCESS_TRANSFER_SRC     = 2,
+	RENDER_ACCESS_TRANSFER_DST     = 3,
+	RENDER_ACCESS_COUNT            = 4,
+};
+
+struct Render_Image_Description {
+	VkFormat format;
+	VkExtent2D extent;
+	VkImageUsageFlags usage;
+};
+
+typedef void (*Render_Pass_Callback)(VkCommandBuffer command_buffer, void *user_data);
+
+bool render_graph_init();
+void render_graph_shutdown();
+
+// starts describing the frame in flight c.current_frame
+void render_graph_begin();
+
+// an image the graph doesn't own (the swapchain image), it is left in final_layout at the end of the frame;
+// contents are only kept if the image comes in with a defined initial_layout
+Render_Resource render_graph_import_image(VkImage image, VkImageView image_view, VkFormat format, VkExtent2D extent, VkImageLayout final_layout, VkImageLayout initial_layout = VK_IMAGE_LAYOUT_UNDEFINED);
+// lives only inside this frame; its memory is shared with other transients whose lifetimes don't overlap.
+// @ToDo: no pass creates a transient yet (the frame is one pass into the swapchain image), so the placement and
+// aliasing behind this has never run; whoever adds the first intermediate target gets to validate it.
+Render_Resource render_graph_create_image(const Render_Image_Description &description);
+
+Render_Pass render_graph_add_pass(const char *name, Render_Pass_Callback callback, void *user_data, uint32 flags = RENDER_PASS_FLAGS_NONE);
+void render_graph_write_color(Render_Pass pass, Render_Resource resource, const VkClearValue *clear_value = 0); // 0 loads
+void render_graph_read(Render_Pass pass, Render_Resource resource, Render_Access access);
+void render_graph_write(Render_Pass pass, Render_Resource resource, Render_Access access);
+
+bool render_graph_compile();
+void render_graph_execute(VkCommandBuffer command_buffer);
+
+// only valid between compile and the end of the frame
+VkImage render_graph_get_image(Render_Resource resource);
+VkImageView render_graph_get_image_view(Render_Resource resource);
+
+#endif
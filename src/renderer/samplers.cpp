@@ -0,0 +1,138 @@
+#include "samplers.hpp"
+
+#include "platform.hpp"
+#include "hash.hpp"
+#include "renderer/vulkan_init.hpp"
+
+#include <vulkan/vulkan.h>
+
+#include <unordered_map>
+
+//
+// Internal
+//
+
+// the create info minus sType and pNext; every member is four bytes, so there is no padding to hash
+struct Sampler_Key {
+	VkSamplerCreateFlags flags;
+	VkFilter mag_filter;
+	VkFilter min_filter;
+	VkSamplerMipmapMode mipmap_mode;
+	VkSamplerAddressMode address_mode_u;
+	VkSamplerAddressMode address_mode_v;
+	VkSamplerAddressMode address_mode_w;
+	float mip_lod_bias;
+	VkBool32 anisotropy_enable;
+	float max_anisotropy;
+	VkBool32 compare_enable;
+	VkCompareOp compare_op;
+	float min_lod;
+	float max_lod;
+	VkBorderColor border_color;
+	VkBool32 unnormalized_coordinates;
+
+	bool operator==(const Sampler_Key &other) const = default;
+};
+
+struct Sampler_Key_Hash {
+	size_t operator()(const Sampler_Key &key) const {
+		return static_cast<size_t>(hash_bytes(&key, sizeof(Sampler_Key)));
+	}
+};
+
+struct Sampler_Cache {
+	std::unordered_map<Sampler_Key, VkSampler, Sampler_Key_Hash> samplers;
+	VkSampler immutable_samplers[SAMPLER_COUNT];
+};
+
+global_variable Sampler_Cache sampler_cache = {};
+
+internal_function VkSamplerCreateInfo make_sampler_info(VkFilter filter, VkSamplerAddressMode address_mode) {
+	VkSamplerCreateInfo sampler_info = {
+		.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO,
+		.magFilter = filter,
+		.minFilter = filter,
+		.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST,
+		.addressModeU = address_mode,
+		.addressModeV = address_mode,
+		.addressModeW = address_mode,
+		.mipLodBias = 0.0f,
+		.anisotropyEnable = VK_FALSE,
+		.compareEnable = VK_FALSE,
+		.compareOp = VK_COMPARE_OP_ALWAYS,
+		.minLod = 0.0f,
+		.maxLod = VK_LOD_CLAMP_NONE, // every mip level a texture has
+		.borderColor = VK_BORDER_COLOR_INT_OPAQUE_BLACK,
+		.unnormalizedCoordinates = VK_FALSE,
+	};
+	return sampler_info;
+}
+
+//
+// Exported
+//
+
+bool sampler_cache_init() {
+	// in Sampler_Id order
+	VkSamplerCreateInfo sampler_infos[SAMPLER_COUNT] = {
+		make_sampler_info(VK_FILTER_NEAREST, VK_SAMPLER_ADDRESS_MODE_REPEAT),
+		make_sampler_info(VK_FILTER_LINEAR, VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE),
+	};
+
+	for (uint32 id = 0; id < SAMPLER_COUNT; ++id) {
+		sampler_cache.immutable_samplers[id] = get_sampler(sampler_infos[id]);
+		if (sampler_cache.immutable_samplers[id] == VK_NULL_HANDLE) return false;
+	}
+
+	return true;
+}
+
+void sampler_cache_shutdown() {
+	for (auto &[key, sampler] : sampler_cache.samplers) {
+		vkDestroySampler(c.device, sampler, 0);
+	}
+	sampler_cache = {};
+}
+
+VkSampler get_sampler(const VkSamplerCreateInfo &sampler_info) {
+	if (sampler_info.pNext) {
+		platform_log("Fatal: Cached samplers can't have a pNext chain!\n");
+		return VK_NULL_HANDLE;
+	}
+
+	Sampler_Key key = {
+		.flags = sampler_info.flags,
+		.mag_filter = sampler_info.magFilter,
+		.min_filter = sampler_info.minFilter,
+		.mipmap_mode = sampler_info.mipmapMode,
+		.address_mode_u = sampler_info.addressModeU,
+		.address_mode_v = sampler_info.addressModeV,
+		.address_mode_w = sampler_info.addressModeW,
+		.mip_lod_bias = sampler_info.mipLodBias,
+		.anisotropy_enable = sampler_info.anisotropyEnable,
+		.max_anisotropy = sampler_info.maxAnisotropy,
+		.compare_enable = sampler_info.compareEnable,
+		.compare_op = sampler_info.compareOp,
+		.min_lod = sampler_info.minLod,
+		.max_lod = sampler_info.maxLod,
+		.border_color = sampler_info.borderColor,
+		.unnormalized_coordinates = sampler_info.unnormalizedCoordinates,
+	};
+
+	auto it = sampler_cache.samplers.find(key);
+	if (it != sampler_cache.samplers.end()) return it->second;
+
+	VkSampler sampler;
+	VkResult result = vkCreateSampler(c.device, &sampler_info, 0, &sampler);
+	if (result != VK_SUCCESS) {
+		platform_log("Fatal: Failed to create a sampler!\n");
+		return VK_NULL_HANDLE;
+	}
+
+	sampler_cache.samplers.emplace(key, sampler);
+	return sampler;
+}
+
+const VkSampler *get_immutable_samplers() {
+	return sampler_cache.immutable_samplers;
+}
@@ -0,0 +1,26 @@
+#ifndef SAMPLERS_H
+#define SAMPLERS_H
+
+#include "types.hpp"
+
+#include <vulkan/vulkan.h>
+
+// NOTE: samplers are few and never change, so textures don't own one. The ones textures pick from are immutable
+// samplers in the bindless set layout (set 1, binding 1) and shaders combine them with the texture there; a texture
+// only carries the index. Keep SAMPLER_COUNT in sync with the samplers[] array in the fragment shaders.
+enum Sampler_Id {
+	SAMPLER_NEAREST_REPEAT = 0, // pixel art, what loaded textures get
+	SAMPLER_LINEAR_CLAMP   = 1, // glyph atlas
+	SAMPLER_COUNT,
+};
+
+bool sampler_cache_init();
+// after the bindless layout is gone, it holds the immutable samplers
+void sampler_cache_shutdown();
+
+// the same create info hands back the same sampler; the cache owns it until shutdown. pNext has to be null.
+VkSampler get_sampler(const VkSamplerCreateInfo &sampler_info);
+// SAMPLER_COUNT samplers, indexed by Sampler_Id
+const VkSampler *get_immutable_samplers();
+
+#endif
@@ -0,0 +1,90 @@
+#include "sprites.hpp"
+
+#include "platform.hpp"
+#include "renderer/vulkan_init.hpp"
+#include "renderer/pipeline.hpp"
+#include "renderer/samplers.hpp"
+#include "renderer/frame_ring.hpp"
+#include "renderer/upload.hpp"
+
+#include <vulkan/vulkan.h>
+
+#include <string.h>
+
+//
+// Internal
+//
+
+struct Sprite_Queue {
+	uint32 count;
+	Sprite_Instance instances[MAX_SPRITES_PER_FRAME];
+};
+
+global_variable Sprite_Queue sprite_queue = {};
+
+internal_function void queue_sprite(const Sprite_Instance &instance) {
+	if (sprite_queue.count == MAX_SPRITES_PER_FRAME) {
+		platform_log("Dropping sprites, more than %u this frame!\n", MAX_SPRITES_PER_FRAME);
+		return;
+	}
+	sprite_queue.instances[sprite_queue.count++] = instance;
+}
+
+//
+// Exported
+//
+
+void sprites_begin_frame() {
+	sprite_queue.count = 0;
+}
+
+void draw_sprite(const Sprite_Family &family, uint32 layer, Vec2 position, Vec2 size) {
+	if (family.layer_count == 0) return;
+	if (!upload_is_acquired(family.upload_value)) return; // streamed in, shows up once the frame took it over
+
+	queue_sprite({
+		.position = position,
+		.size = size,
+		.uv_min = { 0.0f, 0.0f },
+		.uv_max = { 1.0f, 1.0f },
+		.descriptor_index = family.descriptor_index,
+		.layer = layer % family.layer_count,
+	});
+}
+
+void draw_atlas_sprite(const Atlas_Sprite &sprite, Vec2 position, Vec2 size) {
+	if (!upload_is_acquired(sprite.upload_value)) return;
+
+	queue_sprite({
+		.position = position,
+		.size = size,
+		.uv_min = sprite.uv_min,
+		.uv_max = sprite.uv_max,
+		.descriptor_index = sprite.descriptor_index,
+		.layer = sprite.layer,
+	});
+}
+
+void record_sprite_draws(VkCommandBuffer command_buffer) {
+	if (sprite_queue.count == 0) return;
+
+	// NOTE: recorded on a job, the frame ring is the only thing here that has to be thread safe (and is)
+	VkDeviceSize size = sprite_queue.count * sizeof(Sprite_Instance);
+	Frame_Allocation allocation;
+	bool result = frame_ring_allocate(size, alignof(Sprite_Instance), &allocation);
+	if (!result) {
+		platform_log("Failed to allocate %u sprite instances!\n", sprite_queue.count);
+		return;
+	}
+	memcpy(allocation.mapped, sprite_queue.instances, static_cast<size_t>(size));
+
+	vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, c.graphics_pipeline[PIPELINE_SPRITE]);
+
+	VkDeviceSize offset = allocation.offset;
+	vkCmdBindVertexBuffers(command_buffer, 0, 1, &allocation.buffer, &offset);
+
+	uint32 sampler_index = SAMPLER_NEAREST_REPEAT;
+	vkCmdPushConstants(command_buffer, c.pipeline_layout, PUSH_CONSTANT_STAGES, 0, sizeof(uint32), &sampler_index);
+
+	vkCmdDraw(command_buffer, 6, sprite_queue.count, 0, 0);
+}
@@ -0,0 +1,37 @@
+#ifndef SPRITES_H
+#define SPRITES_H
+
+#include "types.hpp"
+#include "math.hpp"
+#include "assets.hpp"
+#include "atlas.hpp"
+
+#include <vulkan/vulkan.h>
+
+// NOTE: sprites are batched like text: draw_sprite only queues an instance, the world draw range turns the whole
+// frame's sprites into one instanced draw (6 vertices per instance, the vertex shader builds the quad). Every
+// instance carries its family's descriptor index and its layer, so sprites of different families and animation
+// frames mix freely in that draw without rebinding anything; atlas sprites (atlas.hpp) are a sub rect of a layer
+// and batch the same way. Instances are written into the frame ring.
+constexpr uint32 MAX_SPRITES_PER_FRAME = 16 * 1024;
+
+// per instance vertex data of the sprite pipeline (VERTEX_LAYOUT_SPRITE_INSTANCE)
+struct Sprite_Instance {
+	Vec2 position; // center, world units
+	Vec2 size;     // world units
+	Vec2 uv_min;
+	Vec2 uv_max;
+	uint32 descriptor_index;
+	uint32 layer;
+};
+
+// forgets the sprites queued last frame
+void sprites_begin_frame();
+// only call from one thread, before the world draw range gets recorded; the layer wraps around the family's count.
+// Sprites whose texture is not acquired yet (upload.hpp) are skipped.
+void draw_sprite(const Sprite_Family &family, uint32 layer, Vec2 position, Vec2 size);
+void draw_atlas_sprite(const Atlas_Sprite &sprite, Vec2 position, Vec2 size);
+// binds the sprite pipeline and draws everything queued this frame in one instanced draw
+void record_sprite_draws(VkCommandBuffer command_buffer);
+
+#endif
@@ -0,0 +1,541 @@
+#include "upload.hpp"
+
+#include "platform.hpp"
+#include "renderer/vulkan_init.hpp"
+#include "renderer/vulkan_helper.hpp"
+
+#include <vulkan/vulkan.h>
+
+#include <string.h>
+#include <deque>
+#include <vector>
+
+//
+// Internal
+//
+
+constexpr VkDeviceSize UPLOAD_STAGING_ALIGNMENT = 16; // covers the texel (or compressed block) size and the 4 byte rule of buffer to image copies
+
+struct Staging_Segment {
+	VkDeviceSize begin;
+	VkDeviceSize end;
+	uint64 timeline_value; // 0 while the batch it belongs to is still being recorded
+};
+
+struct Oversized_Staging {
+	VkBuffer buffer;
+	Memory_Allocation memory;
+};
+
+struct Upload_Submission {
+	uint64 timeline_value;
+	VkCommandBuffer command_buffer;
+	std::vector<Oversized_Staging> oversized_staging;
+};
+
+struct Pending_Acquire {
+	VkImage image;
+	uint32 layer_count;
+	uint32 level_count;
+	uint64 timeline_value;
+};
+
+struct Uploader {
+	VkCommandPool command_pool;
+	VkSemaphore timeline;
+	uint64 next_value;
+	uint64 acquired_value;
+	bool ownership_transfer; // true if uploads run on a different queue family than rendering
+
+	VkBuffer staging_buffer;
+	Memory_Allocation staging_memory;
+	VkDeviceSize head;
+	std::deque<Staging_Segment> segments;
+
+	bool recording;
+	Upload_Submission current;
+	std::vector<Pending_Acquire> current_acquires;
+
+	std::vector<Upload_Submission> in_flight;
+	std::vector<VkCommandBuffer> free_command_buffers;
+	std::vector<Pending_Acquire> pending_acquires;
+};
+
+global_variable Uploader uploader = {};
+
+internal_function uint64 get_completed_value() {
+	uint64 value = 0;
+	vkGetSemaphoreCounterValue(c.device, uploader.timeline, &value);
+	return value;
+}
+
+internal_function void reclaim_finished_uploads() {
+	uint64 completed = get_completed_value();
+
+	for (size_t i = 0; i < uploader.in_flight.size();) {
+		Upload_Submission &submission = uploader.in_flight[i];
+		if (submission.timeline_value > completed) {
+			++i;
+			continue;
+		}
+
+		for (Oversized_Staging &staging : submission.oversized_staging) {
+			destroy_buffer(staging.buffer, staging.memory);
+		}
+		uploader.free_command_buffers.push_back(submission.command_buffer);
+
+		submission = uploader.in_flight.back();
+		uploader.in_flight.pop_back();
+	}
+
+	while (!uploader.segments.empty() && uploader.segments.front().timeline_value != 0 && uploader.segments.front().timeline_value <= completed) {
+		uploader.segments.pop_front();
+	}
+	if (uploader.segments.empty()) {
+		uploader.head = 0;
+	}
+}
+
+// the staging buffer is used as a ring: [front segment, head) is in use, everything else is free
+internal_function bool place_in_ring(VkDeviceSize size, VkDeviceSize *offset) {
+	VkDeviceSize head = (uploader.head + UPLOAD_STAGING_ALIGNMENT - 1) & ~(UPLOAD_STAGING_ALIGNMENT - 1);
+
+	if (uploader.segments.empty()) {
+		*offset = 0;
+		return size <= UPLOAD_STAGING_SIZE;
+	}
+
+	VkDeviceSize tail = uploader.segments.front().begin;
+	if (uploader.head > tail) {
+		if (head + size <= UPLOAD_STAGING_SIZE) {
+			*offset = head;
+			return true;
+		}
+		if (size < tail) { // wrap around, the rest at the end of the buffer is left unused
+			*offset = 0;
+			return true;
+		}
+		return false;
+	}
+
+	if (head + size < tail) {
+		*offset = head;
+		return true;
+	}
+	return false;
+}
+
+internal_function bool open_batch() {
+	if (uploader.recording) return true;
+
+	VkCommandBuffer command_buffer;
+	if (!uploader.free_command_buffers.empty()) {
+		command_buffer = uploader.free_command_buffers.back();
+		uploader.free_command_buffers.pop_back();
+		vkResetCommandBuffer(command_buffer, 0);
+	}
+	else {
+		VkCommandBufferAllocateInfo alloc_info = {
+			.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+			.commandPool = uploader.command_pool,
+			.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+			.commandBufferCount = 1,
+		};
+		VkResult result = vkAllocateCommandBuffers(c.device, &alloc_info, &command_buffer);
+		if (result != VK_SUCCESS) {
+			return false;
+		}
+	}
+
+	VkCommandBufferBeginInfo begin_info = {
+		.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+		.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+	};
+	vkBeginCommandBuffer(command_buffer, &begin_info);
+
+	uploader.current = {};
+	uploader.current.command_buffer = command_buffer;
+	uploader.recording = true;
+	return true;
+}
+
+internal_function bool submit_batch() {
+	if (!uploader.recording) return true;
+
+	if (!uploader.ownership_transfer) {
+		// same queue as rendering: make the copies visible to everything that reads geometry, uniforms or textures
+		VkMemoryBarrier barrier = {
+			.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+			.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+			.dstAccessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT | VK_ACCESS_UNIFORM_READ_BIT | VK_ACCESS_SHADER_READ_BIT,
+		};
+		vkCmdPipelineBarrier(uploader.current.command_buffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 1, &barrier, 0, 0, 0, 0);
+	}
+
+	vkEndCommandBuffer(uploader.current.command_buffer);
+	uploader.recording = false;
+
+	uint64 value = uploader.next_value++;
+	VkTimelineSemaphoreSubmitInfo timeline_info = {
+		.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO,
+		.signalSemaphoreValueCount = 1,
+		.pSignalSemaphoreValues = &value,
+	};
+	VkSubmitInfo submit_info = {
+		.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+		.pNext = &timeline_info,
+		.commandBufferCount = 1,
+		.pCommandBuffers = &uploader.current.command_buffer,
+		.signalSemaphoreCount = 1,
+		.pSignalSemaphores = &uploader.timeline,
+	};
+	VkResult result = vkQueueSubmit(c.transfer_queue, 1, &submit_info, VK_NULL_HANDLE);
+	if (result != VK_SUCCESS) {
+		platform_log("Fatal: Failed to submit an upload batch!\n");
+		return false;
+	}
+
+	for (Staging_Segment &segment : uploader.segments) {
+		if (segment.timeline_value == 0) segment.timeline_value = value;
+	}
+	for (Pending_Acquire &acquire : uploader.current_acquires) {
+		acquire.timeline_value = value;
+		uploader.pending_acquires.push_back(acquire);
+	}
+	uploader.current_acquires.clear();
+
+	uploader.current.timeline_value = value;
+	uploader.in_flight.push_back(uploader.current);
+	uploader.current = {};
+
+	return true;
+}
+
+// NOTE: only the formats we actually upload are in here; everything else is four bytes per texel
+internal_function void get_texel_block(VkFormat format, uint32 *block_extent, uint32 *block_size) {
+	switch (format) {
+	case VK_FORMAT_R8_UNORM:
+		*block_extent = 1;
+		*block_size = 1;
+		break;
+	case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:
+	case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
+		*block_extent = 4;
+		*block_size = 8;
+		break;
+	case VK_FORMAT_BC3_UNORM_BLOCK:
+	case VK_FORMAT_BC3_SRGB_BLOCK:
+	case VK_FORMAT_BC7_UNORM_BLOCK:
+	case VK_FORMAT_BC7_SRGB_BLOCK:
+		*block_extent = 4;
+		*block_size = 16;
+		break;
+	default:
+		*block_extent = 1;
+		*block_size = 4;
+		break;
+	}
+}
+
+// bytes of the whole mip chain, level_sizes (if not null) gets every level's share
+internal_function VkDeviceSize get_image_size(VkFormat format, uint32 width, uint32 height, uint32 layer_count, uint32 level_count, VkDeviceSize *level_sizes) {
+	uint32 block_extent, block_size;
+	get_texel_block(format, &block_extent, &block_size);
+
+	VkDeviceSize size = 0;
+	for (uint32 level = 0; level < level_count; ++level) {
+		uint32 level_width = width >> level ? width >> level : 1;
+		uint32 level_height = height >> level ? height >> level : 1;
+		VkDeviceSize level_size = static_cast<VkDeviceSize>((level_width + block_extent - 1) / block_extent) * ((level_height + block_extent - 1) / block_extent) * block_size * layer_count;
+		if (level_sizes) level_sizes[level] = level_size;
+		size += level_size;
+	}
+	return size;
+}
+
+// hands out size bytes of mapped staging memory, waiting for older uploads only if the ring is full
+internal_function bool reserve_staging(VkDeviceSize size, VkBuffer *buffer, VkDeviceSize *offset, void **mapped) {
+	bool result = open_batch();
+	if (!result) return false;
+
+	if (size > UPLOAD_STAGING_SIZE) {
+		Oversized_Staging staging = {};
+		result = create_buffer(size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, staging.buffer, staging.memory, VK_MEMORY_PROPERTY_HOST_CACHED_BIT);
+		if (!result) return false;
+
+		uploader.current.oversized_staging.push_back(staging);
+		*buffer = staging.buffer;
+		*offset = 0;
+		*mapped = staging.memory.mapped;
+		return true;
+	}
+
+	reclaim_finished_uploads();
+	while (!place_in_ring(size, offset)) {
+		if (uploader.segments.front().timeline_value == 0) {
+			// the ring is full of our own batch, send it off and continue in a new one
+			result = submit_batch() && open_batch();
+			if (!result) return false;
+		}
+
+		result = upload_wait(uploader.segments.front().timeline_value);
+		if (!result) return false;
+		reclaim_finished_uploads();
+	}
+
+	uploader.segments.push_back({ *offset, *offset + size, 0 });
+	uploader.head = *offset + size;
+
+	*buffer = uploader.staging_buffer;
+	*mapped = static_cast<uint8 *>(uploader.staging_memory.mapped) + *offset;
+	return true;
+}
+
+//
+// Exported
+//
+
+bool uploader_init() {
+	uploader.ownership_transfer = c.transfer_family != c.graphics_family;
+	uploader.next_value = 1;
+
+	VkCommandPoolCreateInfo pool_info = {
+		.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+		.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT,
+		.queueFamilyIndex = c.transfer_family,
+	};
+	VkResult result = vkCreateCommandPool(c.device, &pool_info, 0, &uploader.command_pool);
+	if (result != VK_SUCCESS) {
+		return false;
+	}
+
+	VkSemaphoreTypeCreateInfo type_info = {
+		.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO,
+		.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE,
+		.initialValue = 0,
+	};
+	VkSemaphoreCreateInfo semaphore_info = {
+		.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
+		.pNext = &type_info,
+	};
+	result = vkCreateSemaphore(c.device, &semaphore_info, 0, &uploader.timeline);
+	if (result != VK_SUCCESS) {
+		return false;
+	}
+
+	// NOTE: cached if the device has it, mip chains are built in place and read back what they just wrote
+	bool res = create_buffer(UPLOAD_STAGING_SIZE, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, uploader.staging_buffer, uploader.staging_memory, VK_MEMORY_PROPERTY_HOST_CACHED_BIT);
+	if (!res) {
+		return false;
+	}
+
+	return true;
+}
+
+void uploader_shutdown() {
+	submit_batch();
+	upload_wait(uploader.next_value - 1);
+	reclaim_finished_uploads();
+
+	destroy_buffer(uploader.staging_buffer, uploader.staging_memory);
+	vkDestroySemaphore(c.device, uploader.timeline, 0);
+	vkDestroyCommandPool(c.device, uploader.command_pool, 0);
+	uploader = {};
+}
+
+bool upload_begin() {
+	return open_batch();
+}
+
+bool upload_buffer(VkBuffer dst_buffer, VkDeviceSize dst_offset, const void *data, VkDeviceSize size) {
+	if (size == 0) return true;
+
+	VkBuffer staging_buffer;
+	VkDeviceSize staging_offset;
+	void *mapped;
+	bool result = reserve_staging(size, &staging_buffer, &staging_offset, &mapped);
+	if (!result) {
+		return false;
+	}
+
+	memcpy(mapped, data, static_cast<size_t>(size));
+
+	// NOTE: buffers written by uploads are created with concurrent sharing (see create_buffer), so they need
+	// no ownership transfer; the timeline wait of the frame makes the data visible
+	VkBufferCopy copy_region = {
+		.srcOffset = staging_offset,
+		.dstOffset = dst_offset,
+		.size = size,
+	};
+	vkCmdCopyBuffer(uploader.current.command_buffer, staging_buffer, dst_buffer, 1, &copy_region);
+
+	return true;
+}
+
+bool upload_image(VkImage image, VkFormat format, uint32 width, uint32 height, const void *data, VkDeviceSize size, uint32 layer_count, uint32 level_count) {
+	VkDeviceSize image_size = get_image_size(format, width, height, layer_count, level_count, 0);
+	if (image_size != size) {
+		platform_log("Fatal: A %ux%u image with %u layers and %u levels takes %llu bytes, got %llu!\n", width, height, layer_count, level_count, static_cast<unsigned long long>(image_size), static_cast<unsigned long long>(size));
+		return false;
+	}
+
+	Image_Upload upload;
+	bool result = upload_image_reserve(image, format, width, height, layer_count, level_count, &upload);
+	if (!result) return false;
+
+	memcpy(upload.mapped, data, static_cast<size_t>(size));
+
+	return upload_image_commit(&upload);
+}
+
+bool upload_image_reserve(VkImage image, VkFormat format, uint32 width, uint32 height, uint32 layer_count, uint32 level_count, Image_Upload *upload) {
+	if (level_count > MAX_UPLOAD_MIP_LEVELS) {
+		platform_log("Fatal: Can't upload %u mip levels, at most %u!\n", level_count, MAX_UPLOAD_MIP_LEVELS);
+		return false;
+	}
+
+	*upload = {
+		.image = image,
+		.format = format,
+		.width = width,
+		.height = height,
+		.layer_count = layer_count,
+		.level_count = level_count,
+		.size = get_image_size(format, width, height, layer_count, level_count, 0),
+	};
+	return reserve_staging(upload->size, &upload->staging_buffer, &upload->staging_offset, &upload->mapped);
+}
+
+bool upload_image_commit(const Image_Upload *upload) {
+	VkCommandBuffer command_buffer = uploader.current.command_buffer;
+
+	VkImageMemoryBarrier barrier = {
+		.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+		.srcAccessMask = 0,
+		.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+		.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+		.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+		.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+		.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+		.image = upload->image,
+		.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, upload->level_count, 0, upload->layer_count },
+	};
+	vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, 0, 0, 0, 1, &barrier);
+
+	// one region per mip level, the layers of a level follow each other in the buffer
+	VkDeviceSize level_sizes[MAX_UPLOAD_MIP_LEVELS];
+	get_image_size(upload->format, upload->width, upload->height, upload->layer_count, upload->level_count, level_sizes);
+
+	VkBufferImageCopy regions[MAX_UPLOAD_MIP_LEVELS];
+	VkDeviceSize level_offset = upload->staging_offset;
+	for (uint32 level = 0; level < upload->level_count; ++level) {
+		uint32 level_width = upload->width >> level ? upload->width >> level : 1;
+		uint32 level_height = upload->height >> level ? upload->height >> level : 1;
+		regions[level] = {
+			.bufferOffset = level_offset,
+			.bufferRowLength = 0,
+			.bufferImageHeight = 0,
+			.imageSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, level, 0, upload->layer_count },
+			.imageOffset = { 0, 0, 0 },
+			.imageExtent = { level_width, level_height, 1 },
+		};
+		level_offset += level_sizes[level];
+	}
+	vkCmdCopyBufferToImage(command_buffer, upload->staging_buffer, upload->image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, upload->level_count, regions);
+
+	barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+	barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+	if (uploader.ownership_transfer) {
+		// release half of the queue family ownership transfer, upload_record_acquires records the matching acquire
+		barrier.dstAccessMask = 0;
+		barrier.srcQueueFamilyIndex = c.transfer_family;
+		barrier.dstQueueFamilyIndex = c.graphics_family;
+		vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, 0, 0, 0, 1, &barrier);
+
+		uploader.current_acquires.push_back({ upload->image, upload->layer_count, upload->level_count, 0 });
+	}
+	else {
+		barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+		vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, 0, 0, 0, 1, &barrier);
+	}
+
+	return true;
+}
+
+bool upload_end(uint64 *timeline_value) {
+	bool result = submit_batch();
+	*timeline_value = uploader.next_value - 1;
+	return result;
+}
+
+uint64 upload_get_recording_value() {
+	return uploader.next_value;
+}
+
+bool upload_flush() {
+	return submit_batch();
+}
+
+bool upload_wait(uint64 timeline_value) {
+	VkSemaphoreWaitInfo wait_info = {
+		.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO,
+		.semaphoreCount = 1,
+		.pSemaphores = &uploader.timeline,
+		.pValues = &timeline_value,
+	};
+	VkResult result = vkWaitSemaphores(c.device, &wait_info, UINT64_MAX);
+	return result == VK_SUCCESS;
+}
+
+bool upload_is_complete(uint64 timeline_value) {
+	return get_completed_value() >= timeline_value;
+}
+
+bool upload_is_acquired(uint64 timeline_value) {
+	return timeline_value <= uploader.acquired_value;
+}
+
+uint64 upload_record_acquires(VkCommandBuffer command_buffer) {
+	uint64 completed = get_completed_value();
+	if (completed <= uploader.acquired_value) {
+		return 0;
+	}
+
+	std::vector<VkImageMemoryBarrier> barriers;
+	for (size_t i = 0; i < uploader.pending_acquires.size();) {
+		Pending_Acquire acquire = uploader.pending_acquires[i];
+		if (acquire.timeline_value > completed) {
+			++i;
+			continue;
+		}
+
+		VkImageMemoryBarrier barrier = {
+			.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+			.srcAccessMask = 0,
+			.dstAccessMask = VK_ACCESS_SHADER_READ_BIT,
+			.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+			.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+			.srcQueueFamilyIndex = c.transfer_family,
+			.dstQueueFamilyIndex = c.graphics_family,
+			.image = acquire.image,
+			.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, acquire.level_count, 0, acquire.layer_count },
+		};
+		barriers.push_back(barrier);
+
+		uploader.pending_acquires[i] = uploader.pending_acquires.back();
+		uploader.pending_acquires.pop_back();
+	}
+
+	// NOTE: the frame waits on the timeline with ALL_COMMANDS, which chains with the source stage here
+	if (!barriers.empty()) {
+		vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, 0, 0, 0, static_cast<uint32>(barriers.size()), barriers.data());
+	}
+
+	uploader.acquired_value = completed;
+	return completed;
+}
+
+VkSemaphore upload_get_timeline_semaphore() {
+	return uploader.timeline;
+}
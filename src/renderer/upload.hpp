@@ -0,0 +1,62 @@
+#ifndef UPLOAD_H
+#define UPLOAD_H
+
+#include "types.hpp"
+
+#include <vulkan/vulkan.h>
+
+// NOTE: uploads run on the transfer queue (the graphics queue if the device has no separate transfer family).
+// Everything recorded between upload_begin and upload_end goes out as one submission that signals a value on
+// the upload timeline semaphore. Staging memory is a ring that is reclaimed as those values complete, so the
+// cpu only waits if we stream faster than the copy engine can keep up.
+//
+// At init everything goes into one batch between upload_begin and upload_end. Uploads at runtime (streaming) may
+// go without upload_begin, the batch they open is submitted by upload_flush once per frame. Either way nothing
+// may use the destination before upload_is_acquired(value) with the upload_get_recording_value the upload was
+// recorded under: until then the copy may still be running and images may still belong to the transfer queue.
+constexpr VkDeviceSize UPLOAD_STAGING_SIZE = 32ull * 1024 * 1024;
+constexpr uint32 MAX_UPLOAD_MIP_LEVELS = 16; // a 32768 texel wide image, far more than maxImageDimension2D
+
+struct Image_Upload {
+	VkImage image;
+	VkFormat format;
+	uint32 width;
+	uint32 height;
+	uint32 layer_count;
+	uint32 level_count;
+	VkDeviceSize size; // of the whole mip chain
+	VkBuffer staging_buffer;
+	VkDeviceSize staging_offset;
+	void *mapped; // size bytes, valid until the commit
+};
+
+bool uploader_init();
+void uploader_shutdown();
+
+bool upload_begin();
+bool upload_buffer(VkBuffer dst_buffer, VkDeviceSize dst_offset, const void *data, VkDeviceSize size);
+// data holds level_count mip levels, one after the other, and every level holds layer_count tightly packed layers;
+// block compressed formats are whole 4x4 blocks, row after row
+bool upload_image(VkImage image, VkFormat format, uint32 width, uint32 height, const void *data, VkDeviceSize size, uint32 layer_count = 1, uint32 level_count = 1);
+// NOTE: for whoever produces the texels anyway (image decoders, mip generation): reserve the staging memory
+// first, write the image straight into upload->mapped in upload_image's layout and commit. Nothing else may go
+// through the uploader in between; an upload that is never committed only wastes its staging memory.
+bool upload_image_reserve(VkImage image, VkFormat format, uint32 width, uint32 height, uint32 layer_count, uint32 level_count, Image_Upload *upload);
+bool upload_image_commit(const Image_Upload *upload);
+bool upload_end(uint64 *timeline_value);
+// the timeline value the batch that is being recorded will signal; what the last upload has to be acquired as
+uint64 upload_get_recording_value();
+// submits the batch runtime uploads opened, if there is one; once per frame
+bool upload_flush();
+
+bool upload_wait(uint64 timeline_value);
+bool upload_is_complete(uint64 timeline_value);
+bool upload_is_acquired(uint64 timeline_value);
+
+// Records the queue family acquire barriers for every finished upload into a graphics command buffer. The
+// submit of that command buffer has to wait on the returned semaphore value (0 means nothing to wait for);
+// the value has already been reached, so the wait never stalls the frame.
+uint64 upload_record_acquires(VkCommandBuffer command_buffer);
+VkSemaphore upload_get_timeline_semaphore();
+
+#endif
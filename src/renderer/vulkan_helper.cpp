@@ -4,55 +4,49 @@
 
 #include <vulkan/vulkan.h>
 
-VkCommandBuffer begin_single_time_commands() {
-	VkCommandBufferAllocateInfo alloc_info = {
-		.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
-		.commandPool = c.command_pool,
-		.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
-		.commandBufferCount = 1,
-	};
-
-	VkCommandBuffer command_buffer;
-	vkAllocateCommandBuffers(c.device, &alloc_info, &command_buffer);
-
-	VkCommandBufferBeginInfo begin_info = {
-		.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
-		.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
-	};
-	vkBeginCommandBuffer(command_buffer, &begin_info);
-
-	return command_buffer;
-}
-
-void end_single_time_commands(VkCommandBuffer command_buffer) {
-	vkEndCommandBuffer(command_buffer);
-
-	VkSubmitInfo submit_info = {
-		.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
-		.commandBufferCount = 1,
-		.pCommandBuffers = &command_buffer,
-	};
-	vkQueueSubmit(c.graphics_queue, 1, &submit_info, VK_NULL_HANDLE);
-	vkQueueWaitIdle(c.graphics_queue); // @Speed @Performance; use vkWaitForFences
-
-	vkFreeCommandBuffers(c.device, c.command_pool, 1, &command_buffer);
+internal_function uint32 count_bits(uint32 value) {
+	uint32 count = 0;
+	for (; value; value &= value - 1) ++count;
+	return count;
 }
 
-bool find_memory_type(uint32 type_filter, VkMemoryPropertyFlags property_flags, uint32 *index) {
+bool find_memory_type(uint32 type_filter, VkMemoryPropertyFlags property_flags, uint32 *index, VkMemoryPropertyFlags preferred_flags) {
 	VkPhysicalDeviceMemoryProperties memory_properties = {};
 	vkGetPhysicalDeviceMemoryProperties(c.physical_device, &memory_properties);
 
+	// NOTE: ties go to the lower index, the driver orders the types by preference
+	bool found = false;
+	uint32 best_score = 0;
 	for (uint32 i = 0; i < memory_properties.memoryTypeCount; ++i) {
-		if ((type_filter & (1 << i)) && (memory_properties.memoryTypes[i].propertyFlags & property_flags) == property_flags) {
+		VkMemoryPropertyFlags flags = memory_properties.memoryTypes[i].propertyFlags;
+		if (!(type_filter & (1 << i)) || (flags & property_flags) != property_flags) continue;
+
+		uint32 score = count_bits(flags & preferred_flags);
+		if (!found || score > best_score) {
 			*index = i;
-			return true;
+			best_score = score;
+			found = true;
 		}
 	}
 
-	return false;
+	return found;
+}
+
+bool is_directly_writable(const Memory_Allocation &memory) {
+	if (!memory.mapped) return false;
+
+	VkPhysicalDeviceMemoryProperties memory_properties = {};
+	vkGetPhysicalDeviceMemoryProperties(c.physical_device, &memory_properties);
+	return (memory_properties.memoryTypes[memory.memory_type_index].propertyFlags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT) != 0;
+}
+
+bool is_format_sampleable(VkFormat format) {
+	VkFormatProperties format_properties = {};
+	vkGetPhysicalDeviceFormatProperties(c.physical_device, format, &format_properties);
+	return (format_properties.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT) != 0;
 }
 
-bool create_buffer(VkDeviceSize size, VkBufferUsageFlags usage_flags, VkMemoryPropertyFlags property_flags, VkBuffer &buffer, VkDeviceMemory &memory) {
+bool create_buffer(VkDeviceSize size, VkBufferUsageFlags usage_flags, VkMemoryPropertyFlags property_flags, VkBuffer &buffer, Memory_Allocation &memory, VkMemoryPropertyFlags preferred_flags) {
 	VkBufferCreateInfo buffer_info = {
 		.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
 		.size = size,
@@ -60,6 +54,15 @@ bool create_buffer(VkDeviceSize size, VkBufferUsageFlags usage_flags, VkMemoryPr
 		.sharingMode = VK_SHARING_MODE_EXCLUSIVE,
 	};
 
+	// NOTE: buffers filled by the transfer queue are shared with the graphics queue, that way uploads into them
+	// need no queue family ownership transfers
+	uint32 queue_family_indices[] = { c.graphics_family, c.transfer_family };
+	if ((usage_flags & VK_BUFFER_USAGE_TRANSFER_DST_BIT) && c.graphics_family != c.transfer_family) {
+		buffer_info.sharingMode = VK_SHARING_MODE_CONCURRENT;
+		buffer_info.queueFamilyIndexCount = 2;
+		buffer_info.pQueueFamilyIndices = queue_family_indices;
+	}
+
 	VkResult result = vkCreateBuffer(c.device, &buffer_info, 0, &buffer);
 	if (result != VK_SUCCESS) {
 		return false;
@@ -67,40 +70,19 @@ bool create_buffer(VkDeviceSize size, VkBufferUsageFlags usage_flags, VkMemoryPr
 
 	VkMemoryRequirements memory_requirements = {};
 	vkGetBufferMemoryRequirements(c.device, buffer, &memory_requirements);
-	uint32 memory_type_index;
-	bool res = find_memory_type(memory_requirements.memoryTypeBits, property_flags, &memory_type_index);
-	if (!res) {
-		return false;
-	}
-	VkMemoryAllocateInfo alloc_info = {
-		.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
-		.allocationSize = memory_requirements.size,
-		.memoryTypeIndex = memory_type_index,
-	};
 
-	// NOTE: don't call vkAllocateMemory for every individual buffer, the number of allocations is limited; instead when allocating memory for a large number of objects, create a custom allocator that splits up a single allocation among many different objects by using the offset parameters
-	// NOTE: maybe go a step further (as driver developers recommend): also store multiple buffers like the vertex buffer and index buffer into a single VkBuffer and use offsets in commands like vkCmdBindVertexBuffers => more cache friendly @Performance
-	result = vkAllocateMemory(c.device, &alloc_info, 0, &memory);
-	if (result != VK_SUCCESS) {
+	bool res = allocate_memory(memory_requirements, property_flags, MEMORY_RESOURCE_LINEAR, &memory, preferred_flags);
+	if (!res) {
+		vkDestroyBuffer(c.device, buffer, 0);
 		return false;
 	}
 
-	vkBindBufferMemory(c.device, buffer, memory, 0);
+	vkBindBufferMemory(c.device, buffer, memory.memory, memory.offset);
 
 	return true;
 }
 
-bool copy_buffer(VkBuffer src_buffer, VkBuffer dst_buffer, VkDeviceSize size) {
-	VkCommandBuffer command_buffer = begin_single_time_commands();
-
-	VkBufferCopy copy_region = {
-		.srcOffset = 0,
-		.dstOffset = 0,
-		.size = size,
-	};
-	vkCmdCopyBuffer(command_buffer, src_buffer, dst_buffer, 1, &copy_region);
-
-	end_single_time_commands(command_buffer);
-
-	return true;
+void destroy_buffer(VkBuffer buffer, Memory_Allocation &memory) {
+	vkDestroyBuffer(c.device, buffer, 0);
+	free_memory(&memory);
 }
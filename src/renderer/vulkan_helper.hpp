@@ -2,15 +2,24 @@
 #define VULKAN_HELPER_H
 
 #include "types.hpp"
+#include "renderer/vulkan_memory.hpp"
 
 #include <vulkan/vulkan.h>
 
-VkCommandBuffer begin_single_time_commands();
-void end_single_time_commands(VkCommandBuffer command_buffer);
+// NOTE: integrated gpus, software drivers (lavapipe) and discrete gpus with resizable BAR have memory that is
+// device local and host visible at once. Buffers the cpu fills (vertices, indices, uniforms, instances) prefer it
+// and get written through their mapping, no staging buffer and no copy. Everywhere else they fall back to the
+// required flags alone.
+constexpr VkMemoryPropertyFlags DIRECT_WRITE_MEMORY = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
 
-bool find_memory_type(uint32 type_filter, VkMemoryPropertyFlags property_flags, uint32 *index);
+// picks a type with all of property_flags, among those the one with most of preferred_flags
+bool find_memory_type(uint32 type_filter, VkMemoryPropertyFlags property_flags, uint32 *index, VkMemoryPropertyFlags preferred_flags = 0);
+// mapped and coherent, a memcpy into memory.mapped is all it takes to fill it
+bool is_directly_writable(const Memory_Allocation &memory);
+// optimal tiling images of format can be sampled (block compressed formats are optional)
+bool is_format_sampleable(VkFormat format);
 
-bool create_buffer(VkDeviceSize size, VkBufferUsageFlags usage_flags, VkMemoryPropertyFlags property_flags, VkBuffer &buffer, VkDeviceMemory &memory);
-bool copy_buffer(VkBuffer src_buffer, VkBuffer dst_buffer, VkDeviceSize size);
+bool create_buffer(VkDeviceSize size, VkBufferUsageFlags usage_flags, VkMemoryPropertyFlags property_flags, VkBuffer &buffer, Memory_Allocation &memory, VkMemoryPropertyFlags preferred_flags = 0);
+void destroy_buffer(VkBuffer buffer, Memory_Allocation &memory);
 
 #endif
@@ -9,7 +9,7 @@
 		HWND hwnd;
 	};
 #elif defined PLATFORM_LINUX
-	// @ToDo: support linux
+	// headless only, there is no window system integration on linux yet
 #elif defined PLATFORM_MACOS
 	// @ToDo: support macos
 #else 
@@ -27,6 +27,17 @@
 #include "vulkan_init.hpp"
 #include "vulkan_helper.hpp"
 #include "pipeline.hpp"
+#include "geometry.hpp"
+#include "upload.hpp"
+#include "bindless.hpp"
+#include "render_graph.hpp"
+#include "offscreen.hpp"
+#include "gpu_profiler.hpp"
+#include "fonts.hpp"
+#include "deletion_queue.hpp"
+#include "frame_ring.hpp"
+#include "samplers.hpp"
+#include "atlas.hpp"
 
 #define STB_IMAGE_IMPLEMENTATION
 #include <lib/stb_image.h>
@@ -42,6 +53,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <assert.h>
+#include <errno.h>
 
 #ifdef _DEBUG
 constexpr bool enable_validation_layers = true;
@@ -52,11 +64,20 @@ constexpr bool enable_validation_layers = false;
 #endif
 
 Global_Vulkan_Context c = {};
+Game_Sprites game_sprites = {};
+
+constexpr const char *GAME_SPRITE_DIRECTORY = "res/textures";
+constexpr const char *GAME_ATLAS_PATH = "res/textures.atlas";
+constexpr uint32 MAX_SWAPCHAIN_IMAGE_COUNT = 16; // way more than any surface offers, the surface clamps it further
+
+global_variable Headless_Settings headless_settings = {};
+global_variable Renderer_Settings renderer_settings = DEFAULT_RENDERER_SETTINGS;
 
 struct QueueFamilyIndices {
 	// fill this out as the need for more queue families arises
 	std::optional<uint32> graphics_family;
 	std::optional<uint32> present_family;
+	std::optional<uint32> transfer_family;
 };
 
 struct SwapchainDetails {
@@ -71,15 +92,30 @@ VKAPI_ATTR VkBool32 VKAPI_CALL vulkan_debug_callback(VkDebugUtilsMessageSeverity
 }
 
 void cleanup_swapchain() {
-	for (size_t i = 0; i < c.swapchain_framebuffers.size(); ++i) {
-		vkDestroyFramebuffer(c.device, c.swapchain_framebuffers[i], 0);
+	if (c.headless) {
+		destroy_offscreen_targets();
+		return;
 	}
 
 	for (size_t i = 0; i < c.swapchain_image_views.size(); ++i) {
 		vkDestroyImageView(c.device, c.swapchain_image_views[i], 0);
 	}
+	c.swapchain_image_views.clear();
 
 	vkDestroySwapchainKHR(c.device, c.swapchain, 0);
+	c.swapchain = VK_NULL_HANDLE;
+}
+
+void recreate_swapchain() {
+	VkSwapchainKHR old_swapchain = c.swapchain;
+	for (VkImageView image_view : c.swapchain_image_views) {
+		defer_destroy_image_view(image_view);
+	}
+	defer_destroy_swapchain(old_swapchain);
+
+	// the old swapchain hands its presentation over to the new one, presents still queued on it finish first
+	create_swapchain(old_swapchain);
+	create_image_views();
 }
 
 SwapchainDetails get_swapchain_support_details(VkPhysicalDevice physical_device) {
@@ -113,30 +149,56 @@ internal_function QueueFamilyIndices get_queue_family_indices(VkPhysicalDevice p
 	}
 	vkGetPhysicalDeviceQueueFamilyProperties(physical_device, &queue_family_count, queue_family_properties_array);
 
+	// NOTE: the best transfer family is a dedicated copy engine (transfer only), then anything that is not
+	// the graphics family, and if there is nothing else we upload through the graphics family
+	int transfer_score = -1;
 	for (uint i = 0; i < queue_family_count; ++i) {
 		VkQueueFamilyProperties queue_family_properties = queue_family_properties_array[i];
-		// NOTE: there might be a change in logic necessary if for some reason another queue family is better
-		if (queue_family_properties.queueFlags & VK_QUEUE_GRAPHICS_BIT) {
+		VkQueueFlags flags = queue_family_properties.queueFlags;
+		if ((flags & VK_QUEUE_GRAPHICS_BIT) && !queue_family_indices.graphics_family.has_value()) {
 			queue_family_indices.graphics_family = i;
 		}
 
 		VkBool32 present_support = false;
-		vkGetPhysicalDeviceSurfaceSupportKHR(physical_device, i, c.surface, &present_support);
-		if (present_support) {
+		if (c.surface) vkGetPhysicalDeviceSurfaceSupportKHR(physical_device, i, c.surface, &present_support);
+		if (present_support && !queue_family_indices.present_family.has_value()) {
 			queue_family_indices.present_family = i;
 		}
 
-		// check if all indices have a value, if they do break the loop early
-		if (queue_family_indices.graphics_family.has_value() && queue_family_indices.present_family.has_value()) {
-			break;
+		// graphics and compute queues implicitly support transfers
+		if (flags & (VK_QUEUE_TRANSFER_BIT | VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT)) {
+			int score = 0;
+			if (!(flags & VK_QUEUE_GRAPHICS_BIT)) score = 1;
+			if (!(flags & (VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT))) score = 2;
+			if (score > transfer_score) {
+				transfer_score = score;
+				queue_family_indices.transfer_family = i;
+			}
 		}
 	}
+	if (transfer_score == 0) {
+		queue_family_indices.transfer_family = queue_family_indices.graphics_family;
+	}
+	// headless never presents, the graphics queue stands in so the rest of the setup doesn't have to care
+	if (c.headless) {
+		queue_family_indices.present_family = queue_family_indices.graphics_family;
+	}
 
 	free(queue_family_properties_array);
 	return queue_family_indices;
 }
 
-void create_swapchain() {
+internal_function VkPresentModeKHR to_vk_present_mode(Present_Mode present_mode) {
+	switch (present_mode) {
+		case PRESENT_MODE_FIFO:         return VK_PRESENT_MODE_FIFO_KHR;
+		case PRESENT_MODE_FIFO_RELAXED: return VK_PRESENT_MODE_FIFO_RELAXED_KHR;
+		case PRESENT_MODE_MAILBOX:      return VK_PRESENT_MODE_MAILBOX_KHR;
+		case PRESENT_MODE_IMMEDIATE:    return VK_PRESENT_MODE_IMMEDIATE_KHR;
+	}
+	return VK_PRESENT_MODE_FIFO_KHR;
+}
+
+void create_swapchain(VkSwapchainKHR old_swapchain) {
 	SwapchainDetails swapchain_support = get_swapchain_support_details(c.physical_device);
 	QueueFamilyIndices queue_family_indices = get_queue_family_indices(c.physical_device);
 
@@ -148,10 +210,12 @@ void create_swapchain() {
 		.surface = c.surface
 	};
 
-	// choose image count
-	uint32 min_image_count = capabilities.minImageCount + 1; // this will most likely equal 3
+	// choose image count, a max of 0 means there is no limit
+	uint32 min_image_count = renderer_settings.swapchain_image_count;
+	if (min_image_count == 0) min_image_count = capabilities.minImageCount + 1; // this will most likely equal 3
+	if (min_image_count < capabilities.minImageCount) min_image_count = capabilities.minImageCount;
 	if (min_image_count > capabilities.maxImageCount && capabilities.maxImageCount != 0) {
-		min_image_count -= 1;
+		min_image_count = capabilities.maxImageCount;
 	}
 	swapchain_info.minImageCount = min_image_count;
 
@@ -200,19 +264,20 @@ void create_swapchain() {
 	swapchain_info.preTransform = capabilities.currentTransform;
 	swapchain_info.compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR;
 
-	// choose present mode
+	// choose present mode, FIFO is the only one every surface supports
+	VkPresentModeKHR wanted_present_mode = to_vk_present_mode(renderer_settings.present_mode);
+	swapchain_info.presentMode = VK_PRESENT_MODE_FIFO_KHR;
 	for (const auto &present_mode : swapchain_support.present_modes) {
-		if (present_mode == VK_PRESENT_MODE_MAILBOX_KHR) {
-			swapchain_info.presentMode = VK_PRESENT_MODE_MAILBOX_KHR;
+		if (present_mode == wanted_present_mode) {
+			swapchain_info.presentMode = wanted_present_mode;
 			break;
 		}
 	}
-	if (swapchain_info.presentMode == 0) {
-		swapchain_info.presentMode = VK_PRESENT_MODE_FIFO_KHR;
+	if (swapchain_info.presentMode != wanted_present_mode) {
+		platform_log("Warning: The surface doesn't support the requested present mode, falling back to FIFO!\n");
 	}
-	swapchain_info.presentMode = VK_PRESENT_MODE_IMMEDIATE_KHR; // temporary; to check the maximum amount of fps you can run at
 	swapchain_info.clipped = VK_TRUE;
-	swapchain_info.oldSwapchain = VK_NULL_HANDLE;
+	swapchain_info.oldSwapchain = old_swapchain;
 
 	VkResult result = vkCreateSwapchainKHR(c.device, &swapchain_info, 0, &c.swapchain);
 	if (VK_SUCCESS != result) {
@@ -260,33 +325,20 @@ void create_image_views() {
 	}
 }
 
-void create_framebuffers() {
-	c.swapchain_framebuffers.resize(c.swapchain_image_views.size());
+internal_function bool32 apply_renderer_settings(const Renderer_Settings &settings) {
+	if (settings.frames_in_flight < 1 || settings.frames_in_flight > MAX_FRAMES_IN_FLIGHT) {
+		platform_log("Fatal: %u frames in flight requested, only 1 to %u are supported!\n", settings.frames_in_flight, MAX_FRAMES_IN_FLIGHT);
+		return GAME_FAILURE;
+	}
 
-	for (size_t i = 0; i < c.swapchain_image_views.size(); ++i) {
-		VkImageView attachments[] = {
-			c.swapchain_image_views[i],
-		};
+	renderer_settings = settings;
+	c.frames_in_flight = settings.frames_in_flight;
+	c.current_frame = 0;
 
-		VkFramebufferCreateInfo framebuffer_info = {
-			.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO,
-			.renderPass = c.main_pass,
-			.attachmentCount = 1,
-			.pAttachments = attachments,
-			.width = c.swapchain_image_extent.width,
-			.height = c.swapchain_image_extent.height,
-			.layers = 1,
-		};
-
-		VkResult result = vkCreateFramebuffer(c.device, &framebuffer_info, 0, &c.swapchain_framebuffers[i]);
-		if (VK_SUCCESS != result) {
-			platform_log("Fatal: Failed to create framebuffer!\n");
-			assert(VK_SUCCESS == result);
-		}
-	}
+	return GAME_SUCCESS;
 }
 
-bool32 renderer_vulkan_init() {
+internal_function bool32 init_vulkan() {
 	// debug callback: which messages are filtered and which are not
 	VkDebugUtilsMessengerCreateInfoEXT messenger_info = {};
 	messenger_info.sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_MESSENGER_CREATE_INFO_EXT;
@@ -302,7 +354,7 @@ bool32 renderer_vulkan_init() {
 	messenger_info.pfnUserCallback = vulkan_debug_callback;
 
 	const char *device_extensions[] = {VK_KHR_SWAPCHAIN_EXTENSION_NAME};
-	uint device_extensions_size = sizeof(device_extensions) / sizeof(device_extensions[0]);
+	uint device_extensions_size = c.headless ? 0 : sizeof(device_extensions) / sizeof(device_extensions[0]);
 
 	//
 	// create vulkan instance
@@ -324,12 +376,14 @@ bool32 renderer_vulkan_init() {
 		};
 		const uint32 layer_count = sizeof(layers) / sizeof(layers[0]);
 
-		const char *extensions[] = {
-			VK_KHR_SURFACE_EXTENSION_NAME,
-			VK_KHR_WIN32_SURFACE_EXTENSION_NAME,
-			VK_EXT_DEBUG_UTILS_EXTENSION_NAME,
-		};
-		uint32_t extension_count = 2;
+		// headless needs no window system integration at all
+		std::vector<const char *> extensions;
+		if (!c.headless) {
+			extensions.push_back(VK_KHR_SURFACE_EXTENSION_NAME);
+#if defined PLATFORM_WINDOWS
+			extensions.push_back(VK_KHR_WIN32_SURFACE_EXTENSION_NAME);
+#endif
+		}
 
 		if (enable_validation_layers) {
 			// check layer support
@@ -364,7 +418,7 @@ bool32 renderer_vulkan_init() {
 
 				instance_info.pNext = &messenger_info;
 
-				++extension_count;
+				extensions.push_back(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
 			}
 			else {
 				platform_log("Validation layers are to be enabled but validation layers are not supported! Continuing without validation layers.\n");
@@ -381,8 +435,8 @@ bool32 renderer_vulkan_init() {
 			instance_info.pNext = 0;
 		}
 
-		instance_info.enabledExtensionCount = extension_count;
-		instance_info.ppEnabledExtensionNames = extensions;
+		instance_info.enabledExtensionCount = static_cast<uint32>(extensions.size());
+		instance_info.ppEnabledExtensionNames = extensions.data();
 
 		VkResult result = vkCreateInstance(&instance_info, 0, &c.instance);
 		if (VK_SUCCESS != result) {
@@ -415,7 +469,8 @@ bool32 renderer_vulkan_init() {
 	//
 	// create surface
 	//
-	{
+	if (!c.headless) {
+#if defined PLATFORM_WINDOWS
 		WindowHandles *window_handles = (WindowHandles *)platform_get_window_handles();
 
 		VkWin32SurfaceCreateInfoKHR surface_info = {};
@@ -428,6 +483,10 @@ bool32 renderer_vulkan_init() {
 			platform_log("Fatal: Failed to create a win32 surface!\n");
 			return GAME_FAILURE;
 		}
+#else
+		platform_log("Fatal: Only headless rendering is supported on this platform!\n");
+		return GAME_FAILURE;
+#endif
 	}
 
 	//
@@ -444,6 +503,9 @@ bool32 renderer_vulkan_init() {
 		}
 		vkEnumeratePhysicalDevices(c.instance, &physical_device_count, physical_devices);
 
+		// headless takes any suitable device if there is no dedicated gpu (integrated, or a software rasterizer like lavapipe)
+		VkPhysicalDevice fallback_device = 0;
+
 		// going through all physical devices and picking the one that is suitable for our needs
 		for (uint i = 0; i < physical_device_count; ++i) {
 			VkPhysicalDevice physical_device = physical_devices[i];
@@ -453,7 +515,28 @@ bool32 renderer_vulkan_init() {
 
 			// find queue families for a physical device
 			QueueFamilyIndices queue_family_indices = get_queue_family_indices(physical_device);
-			bool queue_family_indices_is_complete = queue_family_indices.graphics_family.has_value() && queue_family_indices.present_family.has_value();
+			bool queue_family_indices_is_complete = queue_family_indices.graphics_family.has_value() && queue_family_indices.present_family.has_value() && queue_family_indices.transfer_family.has_value();
+
+			// the uploader synchronizes with the renderer through timeline semaphores (core in 1.2), the render
+			// graph records with dynamic rendering and synchronization2 (core in 1.3)
+			VkPhysicalDeviceVulkan13Features vulkan13_features = {
+				.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES,
+			};
+			VkPhysicalDeviceVulkan12Features vulkan12_features = {
+				.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES,
+				.pNext = &vulkan13_features,
+			};
+			VkPhysicalDeviceFeatures2 features2 = {
+				.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2,
+				.pNext = &vulkan12_features,
+			};
+			bool timeline_semaphore_supported = false;
+			bool render_graph_supported = false;
+			if (physical_device_properties.apiVersion >= VK_API_VERSION_1_3) {
+				vkGetPhysicalDeviceFeatures2(physical_device, &features2);
+				timeline_semaphore_supported = vulkan12_features.timelineSemaphore;
+				render_graph_supported = vulkan13_features.dynamicRendering && vulkan13_features.synchronization2;
+			}
 
 			// are my device extensions supported for this physical device?
 			uint32 property_count;
@@ -466,8 +549,8 @@ bool32 renderer_vulkan_init() {
 			}
 			vkEnumerateDeviceExtensionProperties(physical_device, 0, &property_count, available_device_extensions);
 			uint extensions_supported = 0;
-			bool all_device_extensions_supported = false;
-			for (uint i = 0; i < property_count; ++i) {
+			bool all_device_extensions_supported = device_extensions_size == 0;
+			for (uint i = 0; i < property_count && !all_device_extensions_supported; ++i) {
 				if (0 == strcmp(device_extensions[extensions_supported], available_device_extensions[i].extensionName))
 					++extensions_supported;
 
@@ -483,20 +566,34 @@ bool32 renderer_vulkan_init() {
 			}
 
 			// does this device support the swapchain i want to create?
-			SwapchainDetails swapchain_support = get_swapchain_support_details(physical_device);
-			bool swapchain_supported = !swapchain_support.surface_formats.empty() && !swapchain_support.present_modes.empty();
+			bool swapchain_supported = c.headless;
+			if (!c.headless) {
+				SwapchainDetails swapchain_support = get_swapchain_support_details(physical_device);
+				swapchain_supported = !swapchain_support.surface_formats.empty() && !swapchain_support.present_modes.empty();
+			}
 			
+			// bindless textures need descriptor indexing (core in 1.2)
+			bool descriptor_indexing_supported = bindless_supported(physical_device);
+
 			// search for other devices if the current driver is not a dedicated gpu, doesnt support the required queue families, doesnt support the required device extensions
 			// @ToDo: (potentially support multiple graphics cards)
-			if (queue_family_indices_is_complete && physical_device_properties.deviceType == VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU && all_device_extensions_supported && swapchain_supported) {
+			bool suitable = queue_family_indices_is_complete && all_device_extensions_supported && swapchain_supported && timeline_semaphore_supported && render_graph_supported && descriptor_indexing_supported;
+			if (suitable && physical_device_properties.deviceType == VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU) {
 				// picking physical device here
 				c.physical_device = physical_device;
 				break;
 			}
+			if (suitable && c.headless && !fallback_device) {
+				fallback_device = physical_device;
+			}
 		}
 
 		free(physical_devices);
 
+		if (c.physical_device == 0) {
+			c.physical_device = fallback_device;
+		}
+
 		if (c.physical_device == 0) {
 			platform_error_message_window("Error!", "Your device has no suitable Vulkan driver!");
 			return GAME_FAILURE;
@@ -510,7 +607,7 @@ bool32 renderer_vulkan_init() {
 	//
 	{
 		// queues to be created with the logical device
-		std::set<uint32_t> unique_queue_family_indices = { queue_family_indices.graphics_family.value(), queue_family_indices.present_family.value() };
+		std::set<uint32_t> unique_queue_family_indices = { queue_family_indices.graphics_family.value(), queue_family_indices.present_family.value(), queue_family_indices.transfer_family.value() };
 		VkDeviceQueueCreateInfo *queue_infos = (VkDeviceQueueCreateInfo *)malloc(unique_queue_family_indices.size() * sizeof(VkDeviceQueueCreateInfo));
 		if (!queue_infos)
 		{
@@ -531,11 +628,33 @@ bool32 renderer_vulkan_init() {
 			++i;
 		}
 
-		// device creation; unused for now
+		// device creation
+		// NOTE: block compressed textures are used when the device has them, cooked textures fall back to RGBA8
+		VkPhysicalDeviceFeatures supported_features = {};
+		vkGetPhysicalDeviceFeatures(c.physical_device, &supported_features);
 		VkPhysicalDeviceFeatures device_features{};
+		device_features.textureCompressionBC = supported_features.textureCompressionBC;
+
+		VkPhysicalDeviceVulkan13Features vulkan13_features = {
+			.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES,
+			.synchronization2 = VK_TRUE,
+			.dynamicRendering = VK_TRUE,
+		};
+
+		VkPhysicalDeviceVulkan12Features vulkan12_features = {
+			.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES,
+			.pNext = &vulkan13_features,
+			.shaderSampledImageArrayNonUniformIndexing = VK_TRUE,
+			.descriptorBindingSampledImageUpdateAfterBind = VK_TRUE,
+			.descriptorBindingUpdateUnusedWhilePending = VK_TRUE,
+			.descriptorBindingPartiallyBound = VK_TRUE,
+			.runtimeDescriptorArray = VK_TRUE,
+			.timelineSemaphore = VK_TRUE,
+		};
 
 		VkDeviceCreateInfo device_info{};
 		device_info.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+		device_info.pNext = &vulkan12_features;
 		device_info.queueCreateInfoCount = static_cast<uint32_t>(unique_queue_family_indices.size());
 		device_info.pQueueCreateInfos = queue_infos;
 		// @ToDo: set layer info for older version (since deprecated)?
@@ -555,94 +674,67 @@ bool32 renderer_vulkan_init() {
 		// get handle to graphics queue; these are the same since we chose a queue family that can do both
 		vkGetDeviceQueue(c.device, queue_family_indices.graphics_family.value(), 0, &c.graphics_queue);
 		vkGetDeviceQueue(c.device, queue_family_indices.present_family.value(), 0, &c.present_queue);
+		vkGetDeviceQueue(c.device, queue_family_indices.transfer_family.value(), 0, &c.transfer_queue);
+
+		c.graphics_family = queue_family_indices.graphics_family.value();
+		c.transfer_family = queue_family_indices.transfer_family.value();
 	}
 
 	//
-	// create swapchain
+	// create device memory allocator
 	//
 	{
+		bool result = memory_allocator_init();
+		if (!result) {
+			platform_log("Fatal: Failed to initialize the device memory allocator!\n");
+			return GAME_FAILURE;
+		}
+	}
+
+	//
+	// create swapchain
+	//
+	if (!c.headless) {
 		create_swapchain();
 	}
 
 	//
-	// create image views (framebuffer)
+	// create image views (color attachments)
 	//
-	{
+	if (!c.headless) {
 		create_image_views();
 	}
 
 	//
-	// create render pass
+	// create offscreen targets (headless stand-in for the swapchain)
 	//
-	{
-		VkAttachmentDescription color_attachment_description = {
-			.format = c.swapchain_image_format,
-			.samples = VK_SAMPLE_COUNT_1_BIT,
-			.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR,
-			.storeOp = VK_ATTACHMENT_STORE_OP_STORE,
-			.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE,
-			.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE,
-			.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
-			.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,
-		};
-
-		VkAttachmentReference color_attachment_reference = {
-			.attachment = 0,
-			.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
-		};
-
-		VkSubpassDescription subpass = {
-			.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS,
-			.colorAttachmentCount = 1,
-			.pColorAttachments = &color_attachment_reference,
-		};
-
-		VkSubpassDependency dependency = {
-			.srcSubpass = VK_SUBPASS_EXTERNAL,
-			.dstSubpass = 0,
-			.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
-			.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
-			.srcAccessMask = 0,
-			.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
-		};
-
-		VkRenderPassCreateInfo render_pass_info = {
-			.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO,
-			.attachmentCount = 1,
-			.pAttachments = &color_attachment_description,
-			.subpassCount = 1,
-			.pSubpasses = &subpass,
-			.dependencyCount = 1,
-			.pDependencies = &dependency,
-		};
-
-		VkResult result = vkCreateRenderPass(c.device, &render_pass_info, 0, &c.main_pass);
-		if (result != VK_SUCCESS)
-		{
-			platform_log("Fatal: Failed to create main pass!\n");
+	if (c.headless) {
+		VkExtent2D extent = { headless_settings.width, headless_settings.height };
+		bool result = create_offscreen_targets(extent, headless_settings.read_back);
+		if (!result) {
+			platform_log("Fatal: Failed to create the offscreen targets!\n");
 			return GAME_FAILURE;
 		}
+
+		VkPhysicalDeviceProperties properties;
+		vkGetPhysicalDeviceProperties(c.physical_device, &properties);
+		platform_log("Headless: %ux%u on %s\n", extent.width, extent.height, properties.deviceName);
 	}
 
 	//
 	// create descriptor set layout
 	//
 	{
+		// dynamic, the camera uniforms are somewhere else in the frame ring every frame
 		VkDescriptorSetLayoutBinding ubo_layout_binding = {
 			.binding = 0,
-			.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
+			.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC,
 			.descriptorCount = 1,
 			.stageFlags = VK_SHADER_STAGE_VERTEX_BIT,
 		};
 
-		VkDescriptorSetLayoutBinding sampler_layout_binding = {
-			.binding = 1,
-			.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
-			.descriptorCount = MAX_TEXTURE_BINDINGS, 
-			.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT,
-		};
-
-		VkDescriptorSetLayoutBinding bindings[] = { ubo_layout_binding, sampler_layout_binding };
+		// NOTE: textures are not in here, they live in the bindless set (set 1)
+		VkDescriptorSetLayoutBinding bindings[] = { ubo_layout_binding };
 
 		VkDescriptorSetLayoutCreateInfo layout_info = {
 			.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
@@ -658,35 +750,69 @@ bool32 renderer_vulkan_init() {
 	}
 
 	//
-	// create graphics pipelines
+	// create the immutable samplers, the bindless layout bakes them in
+	//
+	{
+		bool result = sampler_cache_init();
+		if (!result) {
+			platform_log("Fatal: Failed to create the samplers!\n");
+			return GAME_FAILURE;
+		}
+	}
+
+	//
+	// create bindless texture descriptors
 	//
 	{
-		bool result;
+		bool result = bindless_init();
+		if (!result) {
+			platform_log("Fatal: Failed to create the bindless texture descriptors!\n");
+			return GAME_FAILURE;
+		}
+	}
 
-		//
-		// default pipeline
-		//
-		result = create_default_pipeline();
+	//
+	// create pipeline cache
+	//
+	{
+		bool result = create_pipeline_cache(PIPELINE_CACHE_FILE_PATH);
 		if (!result) {
-			platform_log("Fatal: Failed to create the default pipeline!\n");
+			platform_log("Fatal: Failed to create the pipeline cache!\n");
 			return GAME_FAILURE;
 		}
+	}
 
-		//
-		// font pipeline
-		//
-		//result = create_font_pipeline();
+	//
+	// create graphics pipelines (compiled in parallel on the job system)
+	//
+	{
+		bool result = create_pipelines();
 		if (!result) {
-			platform_log("Fatal: Failed to create the font pipeline!\n");
+			platform_log("Fatal: Failed to create the graphics pipelines!\n");
 			return GAME_FAILURE;
 		}
 	}
 
 	//
-	// create framebuffers
+	// create render graph
 	//
 	{
-		create_framebuffers();
+		bool result = render_graph_init();
+		if (!result) {
+			platform_log("Fatal: Failed to create the render graph!\n");
+			return GAME_FAILURE;
+		}
+	}
+
+	//
+	// create gpu profiler (timestamp queries)
+	//
+	{
+		bool result = gpu_profiler_init();
+		if (!result) {
+			platform_log("Fatal: Failed to create the gpu profiler!\n");
+			return GAME_FAILURE;
+		}
 	}
 
 	//
@@ -707,6 +833,39 @@ bool32 renderer_vulkan_init() {
 		}
 	}
 
+	//
+	// create uploader
+	//
+	{
+		bool result = uploader_init();
+		if (!result) {
+			platform_log("Fatal: Failed to create the uploader!\n");
+			return GAME_FAILURE;
+		}
+	}
+
+	//
+	// start the upload batch that carries all startup assets to the gpu
+	//
+	{
+		bool result = upload_begin();
+		if (!result) {
+			platform_log("Fatal: Failed to begin the upload batch!\n");
+			return GAME_FAILURE;
+		}
+	}
+
+	//
+	// create geometry buffer
+	//
+	{
+		bool result = create_geometry_buffer();
+		if (!result) {
+			platform_log("Fatal: Failed to create the geometry buffer!\n");
+			return GAME_FAILURE;
+		}
+	}
+
 	//
 	// create texture assets
 	//
@@ -728,58 +887,67 @@ bool32 renderer_vulkan_init() {
 			return GAME_FAILURE;
 		}
 
-		// Player
-		const Vertex player_verts[] = {
-			{.pos = {-0.5f, -0.5f}, .tex_coord = {0.0f, 0.0f}},
-			{.pos = { 0.5f, -0.5f}, .tex_coord = {1.0f, 0.0f}},
-			{.pos = { 0.5f,  0.5f}, .tex_coord = {1.0f, 1.0f}},
-			{.pos = {-0.5f,  0.5f}, .tex_coord = {0.0f, 1.0f}},
+		// Player, the walk cycle is a sprite family with one layer per frame
+		const char *player_walk_frames[] = {
+			"res/textures/option2.png",
 		};
-		result = create_texture_asset("res/textures/option2.png", player_verts, indices);
+		result = create_sprite_family_asset(player_walk_frames, sizeof(player_walk_frames) / sizeof(player_walk_frames[0]), &game_sprites.player_walk);
 		if (!result) {
-			platform_log("Fatal: Failed to create a player texture!\n");
+			platform_log("Fatal: Failed to create the player sprites!\n");
 			return GAME_FAILURE;
 		}
 
-		// Font
-		const Vertex font_verts[] = {
-			{.pos = {-1.0f, -1.0f}, .tex_coord = {0.0f, 0.0f}},
-			{.pos = { 1.0f, -1.0f}, .tex_coord = {1.0f, 0.0f}},
-			{.pos = { 1.0f,  1.0f}, .tex_coord = {1.0f, 1.0f}},
-			{.pos = {-1.0f,  1.0f}, .tex_coord = {0.0f, 1.0f}}
-		};
-		// @ToDo: create texture asset 
+		// Sprite atlas of everything in res/textures, cooked (-cook_atlas res/textures res/textures.atlas) or packed now
+		if (platform_get_file_size(GAME_ATLAS_PATH) > 0) {
+			result = create_sprite_atlas_asset(GAME_ATLAS_PATH);
+		}
+		else {
+			result = create_sprite_atlas_from_directory(GAME_SPRITE_DIRECTORY);
+		}
+		if (!result || !get_atlas_sprite("option2", &game_sprites.player_icon)) {
+			platform_log("Fatal: Failed to create the sprite atlas!\n");
+			return GAME_FAILURE;
+		}
 	}
 
 	//
-	// create uniform buffer
+	// load fonts, create the (empty) glyph atlas and the glyph instance buffers text is batched into
 	//
 	{
-		float scale = 3.0f;
-		float aspect = (float)c.swapchain_image_extent.width / (float)c.swapchain_image_extent.height;
-		Uniform_Buffer_Object ubo = {
-			.view = identity(),
-			.proj = transpose(orthographic_projection(-aspect * scale, aspect * scale, -scale, scale, 0.1f, 2.0f)),
-		};
-		size_t ubo_size = sizeof(ubo);
-		Uniform_Buffer *uniform = &c.uniform_buffer;
-
-		// creating uniform buffer here (takes ubo, ubo_size, uniform as parameters)
-		VkBuffer staging_buffer;
-		VkDeviceMemory staging_buffer_memory;
-		create_buffer(ubo_size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, staging_buffer, staging_buffer_memory);
-
-		void *data;
-		vkMapMemory(c.device, staging_buffer_memory, 0, static_cast<uint64_t>(ubo_size), 0, &data);
-		memcpy(data, &ubo, ubo_size);
-		vkUnmapMemory(c.device, staging_buffer_memory);
+		bool result = load_default_fonts();
+		if (!result) {
+			platform_log("Fatal: Failed to load the default fonts!\n");
+			return GAME_FAILURE;
+		}
 
-		create_buffer(ubo_size, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, uniform->buffer, uniform->memory);
+		result = create_text_buffers();
+		if (!result) {
+			platform_log("Fatal: Failed to create the text buffers!\n");
+			return GAME_FAILURE;
+		}
+	}
 
-		copy_buffer(staging_buffer, uniform->buffer, ubo_size);
+	//
+	// create frame ring (per frame uniforms and dynamic data, persistently mapped)
+	//
+	{
+		bool result = frame_ring_init();
+		if (!result) {
+			platform_log("Fatal: Failed to create the frame ring!\n");
+			return GAME_FAILURE;
+		}
+	}
 
-		vkDestroyBuffer(c.device, staging_buffer, 0);
-		vkFreeMemory(c.device, staging_buffer_memory, 0);
+	//
+	// submit the upload batch and wait for it once; the first frame acquires the textures
+	//
+	{
+		uint64 upload_value = 0;
+		bool result = upload_end(&upload_value) && upload_wait(upload_value);
+		if (!result) {
+			platform_log("Fatal: Failed to upload the startup assets!\n");
+			return GAME_FAILURE;
+		}
 	}
 
 	//
@@ -788,18 +956,14 @@ bool32 renderer_vulkan_init() {
 	{
 		VkDescriptorPoolSize pool_sizes[] = {
 			{
-				.type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
-				.descriptorCount = static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT),
+				.type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC,
+				.descriptorCount = 1,
 			},
-			{
-				.type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
-				.descriptorCount = static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT),
-			}
 		};
 
 		VkDescriptorPoolCreateInfo pool_info{
 			.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
-			.maxSets = static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT),
+			.maxSets = 1,
 			.poolSizeCount = sizeof(pool_sizes) / sizeof(pool_sizes[0]),
 			.pPoolSizes = pool_sizes,
 		};
@@ -813,67 +977,39 @@ bool32 renderer_vulkan_init() {
 	}
 
 	//
-	// create descriptor sets
+	// create descriptor set
 	//
+	// NOTE: one set for all frames in flight, the frames differ only in the dynamic offset they bind it with
 	{
-		VkDescriptorSetLayout layouts[MAX_FRAMES_IN_FLIGHT];
-		for (uint32 i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i) {
-			layouts[i] = c.descriptor_set_layout;
-		}
 		VkDescriptorSetAllocateInfo alloc_info = {
 			.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
 			.descriptorPool = c.descriptor_pool,
-			.descriptorSetCount = static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT),
-			.pSetLayouts = layouts,
+			.descriptorSetCount = 1,
+			.pSetLayouts = &c.descriptor_set_layout,
 		};
 
-		VkResult result = vkAllocateDescriptorSets(c.device, &alloc_info, c.descriptor_sets);
+		VkResult result = vkAllocateDescriptorSets(c.device, &alloc_info, &c.descriptor_set);
 		if (VK_SUCCESS != result) {
 			platform_log("Fatal: Failed to allocate descriptor sets!\n");
 			return GAME_FAILURE;
 		}
 
-		uint count = get_texture_asset_count();
-		VkDescriptorImageInfo *image_infos = new VkDescriptorImageInfo[count];
-		uint texture_asset_reader = 0;
-		for (uint i = 0; i < count; ++i) {
-			Texture_Asset texture_asset = get_next_texture_asset(&texture_asset_reader);
-
-			image_infos[i].sampler = texture_asset.texture.sampler;
-			image_infos[i].imageView = texture_asset.texture.image_view;
-			image_infos[i].imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-		}
-
-		for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i) {
-			VkDescriptorBufferInfo buffer_info = {
-				.buffer = c.uniform_buffer.buffer,
-				.offset = 0,
-				.range = sizeof(Uniform_Buffer_Object),
-			};
+		VkDescriptorBufferInfo buffer_info = {
+			.buffer = frame_ring_buffer(),
+			.offset = 0,
+			.range = sizeof(Uniform_Buffer_Object),
+		};
 
-			VkWriteDescriptorSet descriptor_writes[] = {
-				{
-					.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
-					.dstSet = c.descriptor_sets[i],
-					.dstBinding = 0,
-					.dstArrayElement = 0,
-					.descriptorCount = 1,
-					.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
-					.pBufferInfo = &buffer_info,
-				},
-				{
-					.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
-					.dstSet = c.descriptor_sets[i],
-					.dstBinding = 1,
-					.dstArrayElement = 0,
-					.descriptorCount = count,
-					.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
-					.pImageInfo = image_infos,
-				}
-			};
-			vkUpdateDescriptorSets(c.device, sizeof(descriptor_writes) / sizeof(descriptor_writes[0]), descriptor_writes, 0, 0);
-		}
-		delete[] image_infos;
+		VkWriteDescriptorSet descriptor_write = {
+			.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+			.dstSet = c.descriptor_set,
+			.dstBinding = 0,
+			.dstArrayElement = 0,
+			.descriptorCount = 1,
+			.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC,
+			.pBufferInfo = &buffer_info,
+		};
+		vkUpdateDescriptorSets(c.device, 1, &descriptor_write, 0, 0);
 	}
 
 	//
@@ -884,7 +1020,7 @@ bool32 renderer_vulkan_init() {
 			.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
 			.commandPool = c.command_pool,
 			.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
-			.commandBufferCount = MAX_FRAMES_IN_FLIGHT, // count of command_buffer
+			.commandBufferCount = c.frames_in_flight, // count of command_buffer
 		};
 
 		VkResult result = vkAllocateCommandBuffers(c.device, &allocate_info, c.command_buffers);
@@ -892,6 +1028,34 @@ bool32 renderer_vulkan_init() {
 			platform_log("Fatal: Failed to allocate command buffers!\n");
 			return GAME_FAILURE;
 		}
+
+		// secondary command buffers, each draw range of each frame gets its own pool so they can be recorded in parallel
+		for (uint32 frame = 0; frame < c.frames_in_flight; ++frame) {
+			for (uint32 range = 0; range < DRAW_RANGE_COUNT; ++range) {
+				VkCommandPoolCreateInfo pool_info = {
+					.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+					.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT,
+					.queueFamilyIndex = c.graphics_family,
+				};
+				result = vkCreateCommandPool(c.device, &pool_info, 0, &c.secondary_command_pools[frame][range]);
+				if (result != VK_SUCCESS) {
+					platform_log("Fatal: Failed to create a secondary command pool!\n");
+					return GAME_FAILURE;
+				}
+
+				VkCommandBufferAllocateInfo secondary_allocate_info = {
+					.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+					.commandPool = c.secondary_command_pools[frame][range],
+					.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY,
+					.commandBufferCount = 1,
+				};
+				result = vkAllocateCommandBuffers(c.device, &secondary_allocate_info, &c.secondary_command_buffers[frame][range]);
+				if (result != VK_SUCCESS) {
+					platform_log("Fatal: Failed to allocate secondary command buffers!\n");
+					return GAME_FAILURE;
+				}
+			}
+		}
 	}
 
 	//
@@ -907,7 +1071,7 @@ bool32 renderer_vulkan_init() {
 			.flags = VK_FENCE_CREATE_SIGNALED_BIT,
 		};
 
-		for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i)
+		for (size_t i = 0; i < c.frames_in_flight; ++i)
 		{
 			if (VK_SUCCESS != vkCreateSemaphore(c.device, &semaphore_info, 0, &c.image_available_semaphores[i]) ||
 				VK_SUCCESS != vkCreateSemaphore(c.device, &semaphore_info, 0, &c.render_finished_semaphores[i]) ||
@@ -919,13 +1083,118 @@ bool32 renderer_vulkan_init() {
 		}
 	}
 
+	log_memory_statistics();
+
 	return GAME_SUCCESS;
 }
 
+// the whole string has to be a number in [min, max], anything else is logged and leaves value as it is
+internal_function void parse_setting(const char *name, const char *text, uint32 min, uint32 max, uint32 *value) {
+	char *end = 0;
+	errno = 0;
+	unsigned long parsed = strtoul(text, &end, 10);
+	if (end == text || *end != '\0' || errno == ERANGE || text[0] == '-' || parsed < min || parsed > max) {
+		platform_log("Warning: Invalid value %s for %s, it has to be between %u and %u! Keeping %u.\n", text, name, min, max, *value);
+		return;
+	}
+	*value = (uint32)parsed;
+}
+
+bool renderer_parse_argument(const char *argument, const char *value, Renderer_Settings *settings) {
+	if (!value) return false;
+
+	if (strcmp(argument, "-frames_in_flight") == 0) {
+		parse_setting(argument, value, 1, MAX_FRAMES_IN_FLIGHT, &settings->frames_in_flight);
+		return true;
+	}
+	if (strcmp(argument, "-swapchain_images") == 0) {
+		parse_setting(argument, value, 0, MAX_SWAPCHAIN_IMAGE_COUNT, &settings->swapchain_image_count);
+		return true;
+	}
+	if (strcmp(argument, "-present") == 0) {
+		if (strcmp(value, "fifo") == 0)              settings->present_mode = PRESENT_MODE_FIFO;
+		else if (strcmp(value, "fifo_relaxed") == 0) settings->present_mode = PRESENT_MODE_FIFO_RELAXED;
+		else if (strcmp(value, "mailbox") == 0)      settings->present_mode = PRESENT_MODE_MAILBOX;
+		else if (strcmp(value, "immediate") == 0)    settings->present_mode = PRESENT_MODE_IMMEDIATE;
+		else platform_log("Warning: Unknown present mode %s!\n", value);
+		return true;
+	}
+
+	return false;
+}
+
+bool32 renderer_vulkan_init(const Renderer_Settings &settings) {
+	c.headless = false;
+	bool32 result = apply_renderer_settings(settings);
+	if (result != GAME_SUCCESS) return result;
+
+	return init_vulkan();
+}
+
+bool32 renderer_vulkan_init_headless(const Headless_Settings &headless, const Renderer_Settings &settings) {
+	if (headless.width == 0 || headless.height == 0) {
+		platform_log("Fatal: Headless rendering needs a non-zero resolution!\n");
+		return GAME_FAILURE;
+	}
+
+	c.headless = true;
+	headless_settings = headless;
+	bool32 result = apply_renderer_settings(settings);
+	if (result != GAME_SUCCESS) return result;
+
+	return init_vulkan();
+}
+
 void renderer_vulkan_cleanup()
 {
-	// @ToDo
+	// NOTE: nothing is in flight once the device is idle, so everything goes in the reverse order of init_vulkan
+	// and the deletion queue is flushed right away instead of waiting for fences
+	vkDeviceWaitIdle(c.device);
+
+	for (uint32 frame = 0; frame < c.frames_in_flight; ++frame) {
+		vkDestroyFence(c.device, c.in_flight_fences[frame], 0);
+		vkDestroySemaphore(c.device, c.render_finished_semaphores[frame], 0);
+		vkDestroySemaphore(c.device, c.image_available_semaphores[frame], 0);
+		for (uint32 range = 0; range < DRAW_RANGE_COUNT; ++range) {
+			vkDestroyCommandPool(c.device, c.secondary_command_pools[frame][range], 0); // frees its command buffer
+		}
+	}
+
+	vkDestroyDescriptorPool(c.device, c.descriptor_pool, 0); // frees the descriptor set
+	frame_ring_shutdown();
+
+	destroy_text_buffers();
+	free_default_fonts();
+	delete_all_texture_assets();
+	delete_all_sprite_atlases();
+	destroy_geometry_buffer();
+	uploader_shutdown();
+	vkDestroyCommandPool(c.device, c.command_pool, 0);
+
+	gpu_profiler_shutdown();
+	render_graph_shutdown();
+	destroy_pipelines();
+	save_pipeline_cache(PIPELINE_CACHE_FILE_PATH);
+	destroy_pipeline_cache();
+
+	// the queue still holds descriptor slots, so before the bindless array goes
+	deletion_queue_flush();
+	bindless_shutdown();
+	sampler_cache_shutdown();
+	vkDestroyDescriptorSetLayout(c.device, c.descriptor_set_layout, 0);
+
 	cleanup_swapchain();
+	memory_allocator_shutdown();
+	vkDestroyDevice(c.device, 0);
+
+	if (c.surface) vkDestroySurfaceKHR(c.instance, c.surface, 0);
+	if (c.debug_callback) {
+		auto destroyDebugUtilsMessenger = (PFN_vkDestroyDebugUtilsMessengerEXT)vkGetInstanceProcAddr(c.instance, "vkDestroyDebugUtilsMessengerEXT");
+		if (destroyDebugUtilsMessenger) destroyDebugUtilsMessenger(c.instance, c.debug_callback, 0);
+	}
+	vkDestroyInstance(c.instance, 0);
+
+	c = {};
 }
 
 void renderer_vulkan_wait_idle()
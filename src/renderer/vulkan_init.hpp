@@ -3,21 +3,29 @@
 
 #include "types.hpp"
 #include "math.hpp"
+#include "renderer/vulkan_memory.hpp"
+#include "renderer/pipeline.hpp"
+#include "assets.hpp"
+#include "atlas.hpp"
 
 #include <vulkan/vulkan.hpp>
 
 #include <vector>
 
-constexpr uint MAX_FRAMES_IN_FLIGHT = 2;
-constexpr uint MAX_TEXTURE_BINDINGS = 2;
+constexpr uint MAX_FRAMES_IN_FLIGHT = 3; // capacity of the per frame arrays, c.frames_in_flight are in use
 
-struct Uniform_Buffer {
-	VkBuffer buffer;
-	VkDeviceMemory memory;
-	void *mapped;
+// NOTE: every range is recorded into its own secondary command buffer on the job system and executed in this
+// order inside the main pass
+enum Draw_Range {
+	DRAW_RANGE_WORLD = 0,
+	DRAW_RANGE_TEXT  = 1,
+	DRAW_RANGE_UI    = 2,
+	DRAW_RANGE_COUNT = 3,
 };
 
 struct Global_Vulkan_Context {
+	bool headless; // no surface and no swapchain, frames go into the offscreen ring (offscreen.hpp)
+	uint32 frames_in_flight; // 1 to MAX_FRAMES_IN_FLIGHT, from Renderer_Settings
 	VkInstance instance;
 	VkDebugUtilsMessengerEXT debug_callback;
 	VkSurfaceKHR surface;
@@ -25,25 +33,30 @@ struct Global_Vulkan_Context {
 	VkDevice device;
 	VkQueue graphics_queue;
 	VkQueue present_queue;
+	VkQueue transfer_queue;
+	uint32 graphics_family;
+	uint32 transfer_family;
 	VkSwapchainKHR swapchain;
 	std::vector<VkImage> swapchain_images;
 	VkFormat swapchain_image_format;
 	VkExtent2D swapchain_image_extent;
 	std::vector<VkImageView> swapchain_image_views;
-	VkRenderPass main_pass;
 	VkDescriptorSetLayout descriptor_set_layout;
+	VkDescriptorSetLayout bindless_set_layout;
 	VkDescriptorPool descriptor_pool;
-	VkDescriptorSet descriptor_sets[MAX_FRAMES_IN_FLIGHT];
-	VkPipelineLayout pipeline_layout[2];
-	VkPipeline graphics_pipeline[2];
-	std::vector<VkFramebuffer> swapchain_framebuffers;
+	VkDescriptorSet descriptor_set; // set 0, the camera uniforms in the frame ring (dynamic offset)
+	VkPipelineCache pipeline_cache;
+	VkPipelineLayout pipeline_layout; // shared by all pipelines
+	VkPipeline graphics_pipeline[PIPELINE_COUNT];
 	VkCommandPool command_pool;
 	VkCommandBuffer command_buffers[MAX_FRAMES_IN_FLIGHT];
+	VkCommandPool secondary_command_pools[MAX_FRAMES_IN_FLIGHT][DRAW_RANGE_COUNT]; // one per recording job, pools are not thread safe
+	VkCommandBuffer secondary_command_buffers[MAX_FRAMES_IN_FLIGHT][DRAW_RANGE_COUNT];
 	VkSemaphore image_available_semaphores[MAX_FRAMES_IN_FLIGHT];
 	VkSemaphore render_finished_semaphores[MAX_FRAMES_IN_FLIGHT];
 	VkFence in_flight_fences[MAX_FRAMES_IN_FLIGHT];
 	uint32 current_frame = 0;
-	Uniform_Buffer uniform_buffer;
+	uint64 frame_number; // frames submitted so far (counted once the image is acquired), retired objects wait on it
 };
 
 struct Uniform_Buffer_Object {
@@ -51,11 +64,20 @@ struct Uniform_Buffer_Object {
 	Mat4 proj;
 };
 
+// the sprites the game draws every frame, created with the texture assets
+struct Game_Sprites {
+	Sprite_Family player_walk; // one layer per walk frame
+	Atlas_Sprite player_icon;  // from the sprite atlas, shown in the corner of the view
+};
+
 extern Global_Vulkan_Context c;
+extern Game_Sprites game_sprites;
 
+// destroys the current swapchain right away, only once the device is idle
 void cleanup_swapchain();
-void create_swapchain();
+void create_swapchain(VkSwapchainKHR old_swapchain = VK_NULL_HANDLE);
 void create_image_views();
-void create_framebuffers();
+// NOTE: recreating doesn't wait for the device, the old swapchain and its views go through the deletion queue
+void recreate_swapchain();
 
 #endif
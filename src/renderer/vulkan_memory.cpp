@@ -0,0 +1,382 @@
+#include "vulkan_memory.hpp"
+
+#include "platform.hpp"
+#include "renderer/vulkan_init.hpp"
+#include "renderer/vulkan_helper.hpp"
+
+#include <vulkan/vulkan.h>
+
+#include <vector>
+#include <algorithm>
+
+//
+// Internal
+//
+
+// NOTE: every block is managed as a buddy system; an allocation of order n is (MIN_ALLOCATION_SIZE << n) bytes big
+// and sits at an offset that is a multiple of its own size, which takes care of every alignment Vulkan can ask for
+constexpr VkDeviceSize DEFAULT_MEMORY_BLOCK_SIZE = 64ull * 1024 * 1024;
+constexpr VkDeviceSize MIN_MEMORY_BLOCK_SIZE = 4ull * 1024 * 1024;
+constexpr VkDeviceSize MIN_ALLOCATION_SIZE = 256;
+constexpr uint32 MAX_BUDDY_ORDERS = 32;
+
+struct Memory_Block_Allocation {
+	VkDeviceSize offset;
+	VkDeviceSize requested_size;
+	uint32 order;
+};
+
+struct Memory_Block {
+	VkDeviceMemory memory;
+	void *mapped;
+	VkDeviceSize size;
+	VkDeviceSize used;
+	VkDeviceSize requested;
+	uint32 max_order;
+	std::vector<VkDeviceSize> free_lists[MAX_BUDDY_ORDERS];
+	std::vector<Memory_Block_Allocation> allocations;
+};
+
+struct Memory_Pool {
+	std::vector<Memory_Block *> blocks; // released blocks stay as null entries so block indices remain stable
+};
+
+struct Memory_Allocator {
+	VkPhysicalDeviceMemoryProperties memory_properties;
+	bool separate_resource_kinds;
+	uint32 max_allocation_count;
+	uint32 device_allocation_count;
+	VkDeviceSize block_sizes[VK_MAX_MEMORY_TYPES];
+	Memory_Pool pools[VK_MAX_MEMORY_TYPES][MEMORY_RESOURCE_KIND_COUNT];
+	uint32 dedicated_allocation_count;
+	VkDeviceSize dedicated_bytes;
+};
+
+global_variable Memory_Allocator allocator = {};
+
+internal_function VkDeviceSize size_for_order(uint32 order) {
+	return MIN_ALLOCATION_SIZE << order;
+}
+
+internal_function uint32 order_for_size(VkDeviceSize size) {
+	uint32 order = 0;
+	while (size_for_order(order) < size) {
+		++order;
+	}
+	return order;
+}
+
+internal_function bool allocate_device_memory(VkDeviceSize size, uint32 memory_type_index, VkDeviceMemory *memory, void **mapped) {
+	if (allocator.device_allocation_count >= allocator.max_allocation_count) {
+		platform_log("Fatal: Out of device memory allocations (maxMemoryAllocationCount = %u)!\n", allocator.max_allocation_count);
+		return false;
+	}
+
+	VkMemoryAllocateInfo alloc_info = {
+		.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+		.allocationSize = size,
+		.memoryTypeIndex = memory_type_index,
+	};
+	VkResult result = vkAllocateMemory(c.device, &alloc_info, 0, memory);
+	if (result != VK_SUCCESS) {
+		return false;
+	}
+	++allocator.device_allocation_count;
+
+	*mapped = 0;
+	if (allocator.memory_properties.memoryTypes[memory_type_index].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) {
+		// NOTE: host visible memory stays mapped for its whole lifetime, mapping is not free on every driver
+		result = vkMapMemory(c.device, *memory, 0, VK_WHOLE_SIZE, 0, mapped);
+		if (result != VK_SUCCESS) {
+			vkFreeMemory(c.device, *memory, 0);
+			--allocator.device_allocation_count;
+			return false;
+		}
+	}
+
+	return true;
+}
+
+internal_function void free_device_memory(VkDeviceMemory memory, void *mapped) {
+	if (mapped) {
+		vkUnmapMemory(c.device, memory);
+	}
+	vkFreeMemory(c.device, memory, 0);
+	--allocator.device_allocation_count;
+}
+
+internal_function Memory_Block *create_memory_block(uint32 memory_type_index) {
+	Memory_Block *block = new Memory_Block;
+	block->size = allocator.block_sizes[memory_type_index];
+	block->used = 0;
+	block->requested = 0;
+	block->max_order = order_for_size(block->size);
+
+	bool result = allocate_device_memory(block->size, memory_type_index, &block->memory, &block->mapped);
+	if (!result) {
+		delete block;
+		return 0;
+	}
+
+	block->free_lists[block->max_order].push_back(0);
+	return block;
+}
+
+internal_function void destroy_memory_block(Memory_Block *block) {
+	free_device_memory(block->memory, block->mapped);
+	delete block;
+}
+
+internal_function bool block_allocate(Memory_Block *block, uint32 order, VkDeviceSize *offset) {
+	if (order > block->max_order) return false;
+
+	uint32 free_order = order;
+	while (free_order <= block->max_order && block->free_lists[free_order].empty()) {
+		++free_order;
+	}
+	if (free_order > block->max_order) return false;
+
+	VkDeviceSize free_offset = block->free_lists[free_order].back();
+	block->free_lists[free_order].pop_back();
+
+	// split the free range until it has the size we need, the upper halves become free buddies
+	while (free_order > order) {
+		--free_order;
+		block->free_lists[free_order].push_back(free_offset + size_for_order(free_order));
+	}
+
+	block->used += size_for_order(order);
+	*offset = free_offset;
+	return true;
+}
+
+internal_function void block_free(Memory_Block *block, VkDeviceSize offset, uint32 order) {
+	block->used -= size_for_order(order);
+
+	while (order < block->max_order) {
+		VkDeviceSize buddy = offset ^ size_for_order(order);
+		std::vector<VkDeviceSize> &free_list = block->free_lists[order];
+		auto it = std::find(free_list.begin(), free_list.end(), buddy);
+		if (it == free_list.end()) {
+			break;
+		}
+		*it = free_list.back();
+		free_list.pop_back();
+
+		offset = std::min(offset, buddy);
+		++order;
+	}
+
+	block->free_lists[order].push_back(offset);
+}
+
+internal_function VkDeviceSize block_largest_free_range(Memory_Block *block) {
+	for (int32 order = block->max_order; order >= 0; --order) {
+		if (!block->free_lists[order].empty()) {
+			return size_for_order(order);
+		}
+	}
+	return 0;
+}
+
+internal_function uint32 kind_index(Memory_Resource_Kind kind) {
+	return allocator.separate_resource_kinds ? static_cast<uint32>(kind) : 0;
+}
+
+internal_function bool pool_allocate(uint32 memory_type_index, Memory_Resource_Kind kind, VkDeviceSize requested_size, uint32 order, Memory_Allocation *allocation) {
+	Memory_Pool *pool = &allocator.pools[memory_type_index][kind_index(kind)];
+
+	VkDeviceSize offset = 0;
+	uint32 block_index = DEDICATED_MEMORY_BLOCK;
+	for (uint32 i = 0; i < pool->blocks.size(); ++i) {
+		Memory_Block *block = pool->blocks[i];
+		if (!block) continue;
+
+		if (block_allocate(block, order, &offset)) {
+			block_index = i;
+			break;
+		}
+	}
+
+	if (block_index == DEDICATED_MEMORY_BLOCK) {
+		Memory_Block *block = create_memory_block(memory_type_index);
+		if (!block) return false;
+
+		auto free_slot = std::find(pool->blocks.begin(), pool->blocks.end(), nullptr);
+		if (free_slot != pool->blocks.end()) {
+			*free_slot = block;
+			block_index = static_cast<uint32>(free_slot - pool->blocks.begin());
+		}
+		else {
+			pool->blocks.push_back(block);
+			block_index = static_cast<uint32>(pool->blocks.size() - 1);
+		}
+
+		bool result = block_allocate(block, order, &offset);
+		if (!result) return false;
+	}
+
+	Memory_Block *block = pool->blocks[block_index];
+	block->requested += requested_size;
+	block->allocations.push_back({ offset, requested_size, order });
+
+	allocation->memory = block->memory;
+	allocation->offset = offset;
+	allocation->size = requested_size;
+	allocation->mapped = block->mapped ? static_cast<uint8 *>(block->mapped) + offset : 0;
+	allocation->memory_type_index = memory_type_index;
+	allocation->block_index = block_index;
+	allocation->order = order;
+	allocation->kind = kind;
+
+	return true;
+}
+
+//
+// Exported
+//
+
+bool memory_allocator_init() {
+	vkGetPhysicalDeviceMemoryProperties(c.physical_device, &allocator.memory_properties);
+
+	VkPhysicalDeviceProperties properties = {};
+	vkGetPhysicalDeviceProperties(c.physical_device, &properties);
+	allocator.max_allocation_count = properties.limits.maxMemoryAllocationCount;
+
+	// every buddy range starts at a multiple of MIN_ALLOCATION_SIZE, so only a bigger granularity can make
+	// buffers and optimal images share a page
+	allocator.separate_resource_kinds = properties.limits.bufferImageGranularity > MIN_ALLOCATION_SIZE;
+
+	for (uint32 i = 0; i < allocator.memory_properties.memoryTypeCount; ++i) {
+		VkMemoryType memory_type = allocator.memory_properties.memoryTypes[i];
+		VkDeviceSize heap_size = allocator.memory_properties.memoryHeaps[memory_type.heapIndex].size;
+
+		// small heaps (e.g. the 256 MB BAR window) get smaller blocks so a single block can't eat them up
+		VkDeviceSize block_size = DEFAULT_MEMORY_BLOCK_SIZE;
+		while (block_size > heap_size / 8 && block_size > MIN_MEMORY_BLOCK_SIZE) {
+			block_size /= 2;
+		}
+		allocator.block_sizes[i] = block_size;
+	}
+
+	return true;
+}
+
+void memory_allocator_shutdown() {
+	for (uint32 i = 0; i < VK_MAX_MEMORY_TYPES; ++i) {
+		for (uint32 j = 0; j < MEMORY_RESOURCE_KIND_COUNT; ++j) {
+			Memory_Pool *pool = &allocator.pools[i][j];
+			for (Memory_Block *block : pool->blocks) {
+				if (block) destroy_memory_block(block);
+			}
+			pool->blocks.clear();
+		}
+	}
+}
+
+bool allocate_memory(const VkMemoryRequirements &requirements, VkMemoryPropertyFlags property_flags, Memory_Resource_Kind kind, Memory_Allocation *allocation, VkMemoryPropertyFlags preferred_flags) {
+	if (requirements.size == 0) return false;
+
+	uint32 memory_type_index;
+	bool result = find_memory_type(requirements.memoryTypeBits, property_flags, &memory_type_index, preferred_flags);
+	if (!result) {
+		return false;
+	}
+
+	VkDeviceSize needed_size = std::max(requirements.size, requirements.alignment);
+
+	// big resources get their own allocation, splitting a block for them would mostly waste it
+	if (needed_size > allocator.block_sizes[memory_type_index] / 2) {
+		void *mapped;
+		result = allocate_device_memory(requirements.size, memory_type_index, &allocation->memory, &mapped);
+		if (!result) return false;
+
+		allocation->offset = 0;
+		allocation->size = requirements.size;
+		allocation->mapped = mapped;
+		allocation->memory_type_index = memory_type_index;
+		allocation->block_index = DEDICATED_MEMORY_BLOCK;
+		allocation->order = 0;
+		allocation->kind = kind;
+
+		++allocator.dedicated_allocation_count;
+		allocator.dedicated_bytes += requirements.size;
+		return true;
+	}
+
+	return pool_allocate(memory_type_index, kind, requirements.size, order_for_size(needed_size), allocation);
+}
+
+void free_memory(Memory_Allocation *allocation) {
+	if (allocation->memory == VK_NULL_HANDLE) return;
+
+	if (allocation->block_index == DEDICATED_MEMORY_BLOCK) {
+		free_device_memory(allocation->memory, allocation->mapped);
+		--allocator.dedicated_allocation_count;
+		allocator.dedicated_bytes -= allocation->size;
+		*allocation = {};
+		return;
+	}
+
+	Memory_Pool *pool = &allocator.pools[allocation->memory_type_index][kind_index(allocation->kind)];
+	Memory_Block *block = pool->blocks[allocation->block_index];
+
+	for (size_t i = 0; i < block->allocations.size(); ++i) {
+		if (block->allocations[i].offset == allocation->offset) {
+			block->requested -= block->allocations[i].requested_size;
+			block->allocations[i] = block->allocations.back();
+			block->allocations.pop_back();
+			break;
+		}
+	}
+	block_free(block, allocation->offset, allocation->order);
+
+	// release empty blocks, but keep the last one around so we don't allocate and free a block over and over
+	if (block->allocations.empty()) {
+		uint32 live_block_count = 0;
+		for (Memory_Block *other : pool->blocks) {
+			if (other) ++live_block_count;
+		}
+		if (live_block_count > 1) {
+			destroy_memory_block(block);
+			pool->blocks[allocation->block_index] = 0;
+		}
+	}
+
+	*allocation = {};
+}
+
+void get_memory_statistics(Memory_Statistics *statistics) {
+	*statistics = {};
+	statistics->dedicated_allocation_count = allocator.dedicated_allocation_count;
+	statistics->allocation_count = allocator.dedicated_allocation_count;
+	statistics->reserved_bytes = allocator.dedicated_bytes;
+	statistics->used_bytes = allocator.dedicated_bytes;
+	statistics->requested_bytes = allocator.dedicated_bytes;
+
+	for (uint32 i = 0; i < VK_MAX_MEMORY_TYPES; ++i) {
+		for (uint32 j = 0; j < MEMORY_RESOURCE_KIND_COUNT; ++j) {
+			for (Memory_Block *block : allocator.pools[i][j].blocks) {
+				if (!block) continue;
+
+				++statistics->block_count;
+				statistics->allocation_count += static_cast<uint32>(block->allocations.size());
+				statistics->reserved_bytes += block->size;
+				statistics->used_bytes += block->used;
+				statistics->requested_bytes += block->requested;
+				statistics->largest_free_range = std::max(statistics->largest_free_range, block_largest_free_range(block));
+			}
+		}
+	}
+}
+
+void log_memory_statistics() {
+	Memory_Statistics statistics;
+	get_memory_statistics(&statistics);
+
+	platform_log("GPU memory: %u blocks, %u dedicated, %u allocations, %u/%u device allocations\n",
+		statistics.block_count, statistics.dedicated_allocation_count, statistics.allocation_count, allocator.device_allocation_count, allocator.max_allocation_count);
+	platform_log("GPU memory: %.2f MB reserved, %.2f MB used, %.2f MB requested, largest free range %.2f MB\n",
+		statistics.reserved_bytes / (1024.0 * 1024.0), statistics.used_bytes / (1024.0 * 1024.0),
+		statistics.requested_bytes / (1024.0 * 1024.0), statistics.largest_free_range / (1024.0 * 1024.0));
+}
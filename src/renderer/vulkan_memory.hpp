@@ -0,0 +1,49 @@
+#ifndef VULKAN_MEMORY_H
+#define VULKAN_MEMORY_H
+
+#include "types.hpp"
+
+#include <vulkan/vulkan.h>
+
+// NOTE: buffers and linear images may not share a bufferImageGranularity page with optimally tiled images,
+// so on devices where that granularity matters the two kinds get their own blocks
+enum Memory_Resource_Kind {
+	MEMORY_RESOURCE_LINEAR     = 0,
+	MEMORY_RESOURCE_OPTIMAL    = 1,
+	MEMORY_RESOURCE_KIND_COUNT = 2,
+};
+
+constexpr uint32 DEDICATED_MEMORY_BLOCK = 0xFFFFFFFF;
+
+struct Memory_Allocation {
+	VkDeviceMemory memory;
+	VkDeviceSize offset;
+	VkDeviceSize size;
+	void *mapped; // points at offset already; null if the memory type is not host visible
+	uint32 memory_type_index;
+	uint32 block_index; // DEDICATED_MEMORY_BLOCK if the allocation owns its VkDeviceMemory
+	uint32 order;
+	Memory_Resource_Kind kind;
+};
+
+struct Memory_Statistics {
+	uint32 block_count;
+	uint32 dedicated_allocation_count;
+	uint32 allocation_count;
+	VkDeviceSize reserved_bytes;  // everything we got from vkAllocateMemory
+	VkDeviceSize used_bytes;      // handed out to resources, including buddy rounding
+	VkDeviceSize requested_bytes; // what the resources actually asked for
+	VkDeviceSize largest_free_range;
+};
+
+bool memory_allocator_init();
+void memory_allocator_shutdown();
+
+// preferred_flags only decide between memory types that have all of property_flags (see find_memory_type)
+bool allocate_memory(const VkMemoryRequirements &requirements, VkMemoryPropertyFlags property_flags, Memory_Resource_Kind kind, Memory_Allocation *allocation, VkMemoryPropertyFlags preferred_flags = 0);
+void free_memory(Memory_Allocation *allocation);
+
+void get_memory_statistics(Memory_Statistics *statistics);
+void log_memory_statistics();
+
+#endif
@@ -5,6 +5,16 @@
 #include "math.hpp"
 #include "assets.hpp"
 #include "fonts.hpp"
+#include "sprites.hpp"
+#include "geometry.hpp"
+#include "upload.hpp"
+#include "bindless.hpp"
+#include "jobs.hpp"
+#include "render_graph.hpp"
+#include "offscreen.hpp"
+#include "gpu_profiler.hpp"
+#include "deletion_queue.hpp"
+#include "frame_ring.hpp"
 
 #define STB_TRUETYPE_IMPLEMENTATION
 #include <lib/stb_truetype.h>
@@ -12,23 +22,25 @@
 
 #include <assert.h>
 #include <stdarg.h>
+#include <string.h>
+#include <math.h>
 
-void wait_for_current_frame_to_finish() {
-	vkWaitForFences(c.device, 1, &c.in_flight_fences[c.current_frame], VK_TRUE, UINT64_MAX);
-	vkResetFences(c.device, 1, &c.in_flight_fences[c.current_frame]);
-}
+constexpr uint32 NO_FRAME_SUBMITTED = 0xFFFFFFFF;
+constexpr real32 PLAYER_WALK_FRAMES_PER_UNIT = 4.0f;
+constexpr real32 PLAYER_ICON_SIZE = 0.5f; // world units
 
-void recreate_swapchain() {
-	vkDeviceWaitIdle(c.device);
+global_variable uint32 last_submitted_frame = NO_FRAME_SUBMITTED;
+global_variable bool swapchain_outdated = false;
+global_variable Window_Dimensions swapchain_window_dimensions = {}; // what the window measured at the last (re)creation
+global_variable uint32 camera_uniform_offset; // this frame's Uniform_Buffer_Object in the frame ring
 
-	cleanup_swapchain();
-
-	create_swapchain();
-	create_image_views();
-	create_framebuffers();
+// NOTE: the fence is only reset right before the submit, a frame that bails out earlier (out of date swapchain)
+// leaves it signaled so the next wait doesn't block forever
+void wait_for_current_frame_to_finish() {
+	vkWaitForFences(c.device, 1, &c.in_flight_fences[c.current_frame], VK_TRUE, UINT64_MAX);
 }
 
-VkCommandBuffer begin_render_pass(VkRenderPass render_pass, VkClearValue *clear_values, uint32_t image_index) {
+VkCommandBuffer begin_command_buffer() {
 	VkCommandBuffer command_buffer = c.command_buffers[c.current_frame];
 	vkResetCommandBuffer(command_buffer, 0);
 
@@ -41,25 +53,12 @@ VkCommandBuffer begin_render_pass(VkRenderPass render_pass, VkClearValue *clear_
 	{
 		platform_log("Fatal: Failed to begin command buffer!\n");
 		assert(result == VK_SUCCESS);
-		return command_buffer;
 	}
 
-	VkRenderPassBeginInfo render_pass_info = {
-		.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO,
-		.renderPass = render_pass,
-		.framebuffer = c.swapchain_framebuffers[image_index],
-		.renderArea = { {0, 0}, c.swapchain_image_extent },
-		.clearValueCount = 1,
-		.pClearValues = clear_values,
-	};
-	vkCmdBeginRenderPass(command_buffer, &render_pass_info, VK_SUBPASS_CONTENTS_INLINE);
-
 	return command_buffer;
 }
 
-void end_render_pass(VkCommandBuffer command_buffer) {
-	vkCmdEndRenderPass(command_buffer);
-
+void end_command_buffer(VkCommandBuffer command_buffer) {
 	VkResult result = vkEndCommandBuffer(command_buffer);
 	if (VK_SUCCESS != result)
 	{
@@ -68,39 +67,33 @@ void end_render_pass(VkCommandBuffer command_buffer) {
 	}
 }
 
-void draw_game(VkCommandBuffer command_buffer, Game_State *game_state) {
+void draw_game(VkCommandBuffer command_buffer) {
 	uint index = 0;
 	Texture_Asset texture_asset; 
 
-	// Draw background
+	// Draw background, unless it is still being streamed in
 	texture_asset = get_next_texture_asset(&index);
-	VkBuffer vertex_buffers2[] = { texture_asset.vertex_buffer.buffer };
-	VkDeviceSize offsets2[] = { 0 };
-
-	vkCmdBindVertexBuffers(command_buffer, 0, 1, vertex_buffers2, offsets2);
-	vkCmdBindIndexBuffer(command_buffer, texture_asset.index_buffer.buffer, 0, VK_INDEX_TYPE_UINT32);
-	vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, c.pipeline_layout[0], 0, 1, &c.descriptor_sets[c.current_frame], 0, 0);
+	if (!upload_is_acquired(texture_asset.texture.upload_value) || !upload_is_acquired(texture_asset.mesh.upload_value)) return;
 	Mat4 model = identity();
-	vkCmdPushConstants(command_buffer, c.pipeline_layout[0], VK_SHADER_STAGE_VERTEX_BIT, 0, 64, &model);
-	int texture_index = 0;
-	vkCmdPushConstants(command_buffer, c.pipeline_layout[0], VK_SHADER_STAGE_FRAGMENT_BIT, 64, sizeof(int), &texture_index); 
+	vkCmdPushConstants(command_buffer, c.pipeline_layout, PUSH_CONSTANT_STAGES, 0, 64, &model);
+	uint32 texture_indices[2] = { texture_asset.texture.descriptor_index, texture_asset.texture.sampler_index };
+	vkCmdPushConstants(command_buffer, c.pipeline_layout, PUSH_CONSTANT_STAGES, 64, sizeof(texture_indices), texture_indices);
 
-	vkCmdDrawIndexed(command_buffer, 6, 1, 0, 0, 0); // @Hardcode: 6 == count of indices
+	vkCmdDrawIndexed(command_buffer, texture_asset.mesh.index_count, 1, texture_asset.mesh.first_index, texture_asset.mesh.vertex_offset, 0);
+}
 
-	// Draw player
-	texture_asset = get_next_texture_asset(&index);
-	VkBuffer vertex_buffers[] = { texture_asset.vertex_buffer.buffer };
-	VkDeviceSize offsets[] = { 0 };
-
-	vkCmdBindVertexBuffers(command_buffer, 0, 1, vertex_buffers, offsets);
-	vkCmdBindIndexBuffer(command_buffer, texture_asset.index_buffer.buffer, 0, VK_INDEX_TYPE_UINT32);
-	vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, c.pipeline_layout[0], 0, 1, &c.descriptor_sets[c.current_frame], 0, 0); // holds uniforms (texture sampler, uniform buffers)
-	model = transpose(translate({ game_state->player.position.x, game_state->player.position.y, 0 }));
-	vkCmdPushConstants(command_buffer, c.pipeline_layout[0], VK_SHADER_STAGE_VERTEX_BIT, 0, 64, &model);
-	texture_index = 1;
-	vkCmdPushConstants(command_buffer, c.pipeline_layout[0], VK_SHADER_STAGE_FRAGMENT_BIT, 64, sizeof(int), &texture_index);
-
-	vkCmdDrawIndexed(command_buffer, 6, 1, 0, 0, 0); // @Hardcode: 6 == count of indices
+// queues the sprites only, the world draw range draws them on top of the background in one instanced draw
+void draw_game_sprites(Game_State *game_state) {
+	// the walk cycle moves on with the distance walked, so the player stands still on one frame
+	Vec2 position = game_state->player.position;
+	uint32 walk_frame = static_cast<uint32>((fabsf(position.x) + fabsf(position.y)) * PLAYER_WALK_FRAMES_PER_UNIT);
+	draw_sprite(game_sprites.player_walk, walk_frame, position, { 1.0f, 1.0f });
+
+	// the icon stays in the top right corner of the view, wherever the camera goes
+	real32 half_height = game_state->camera.half_height;
+	real32 aspect = (real32)c.swapchain_image_extent.width / (real32)c.swapchain_image_extent.height;
+	Vec2 corner = { game_state->camera.position.x + aspect * half_height, game_state->camera.position.y - half_height };
+	draw_atlas_sprite(game_sprites.player_icon, { corner.x - PLAYER_ICON_SIZE, corner.y + PLAYER_ICON_SIZE }, { PLAYER_ICON_SIZE, PLAYER_ICON_SIZE });
 }
 
 void draw_menu(VkCommandBuffer command_buffer) {
@@ -111,7 +104,12 @@ char *get_format_as_string(const char *format, ...) {
 	va_list arg_ptr;
 	va_start(arg_ptr, format);
 
-	uint size = 1 + vsnprintf(0, 0, format, arg_ptr);
+	// the first pass consumes its va_list, the second one needs a fresh one
+	va_list size_arg_ptr;
+	va_copy(size_arg_ptr, arg_ptr);
+	uint size = 1 + vsnprintf(0, 0, format, size_arg_ptr);
+	va_end(size_arg_ptr);
+
 	char *out_message = new char[size];
 	vsnprintf(out_message, static_cast<size_t>(size), format, arg_ptr);
 	
@@ -120,38 +118,139 @@ char *get_format_as_string(const char *format, ...) {
 	return out_message;
 }
 
-void draw_text(VkCommandBuffer command_buffer, Vec2 top_left, const char *text) {
-	stbtt_bakedchar *cdata = get_cdata();
-
-	//char *ch = (char *)text;
-	//while (*ch) {
-	//	if (*ch >= 32 && *ch < 128) {
-	//		stbtt_aligned_quad q;
-	//		stbtt_GetBakedQuad(cdata, 512, 512, *ch - 32, &top_left.x, &top_left.y, &q, 1);
-	//		//platform_log("%c", *ch); 
-
-	//		VkBuffer vertex_buffers[] = { c.vertex_buffer[2].buffer };
-	//		VkDeviceSize offsets[] = { 0 };
-
-	//		vkCmdBindVertexBuffers(command_buffer, 0, 1, vertex_buffers, offsets);
-	//		vkCmdBindIndexBuffer(command_buffer, c.index_buffer[2].buffer, 0, VK_INDEX_TYPE_UINT16);
-	//		vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, c.pipeline_layout, 0, 1, &c.descriptor_sets[c.current_frame], 0, 0); // holds uniforms (texture sampler, uniform buffers)
-	//		Mat4 model = identity();
-	//		vkCmdPushConstants(command_buffer, c.pipeline_layout, VK_SHADER_STAGE_VERTEX_BIT, 0, 64, &model);
-	//		int texture_index = 2;
-	//		vkCmdPushConstants(command_buffer, c.pipeline_layout, VK_SHADER_STAGE_FRAGMENT_BIT, 64, sizeof(int), &texture_index);
-
-	//		vkCmdDrawIndexed(command_buffer, 6, 1, 0, 0, 0); // @Hardcode: 6 == count of indices
-	//	}
-	//	++ch;
-	//}
-	//platform_log("\n");
+// queues the text only, the text draw range draws everything queued this frame at once. The numbers change every
+// frame, caching their layout would only evict the ones that stay.
+void draw_performance_metrics() {
+	char *text = get_format_as_string("%.2f ms cpu %.2f ms gpu", perf_metrics.ms_per_frame, perf_metrics.gpu_ms_per_frame);
+	draw_text_uncached({ 8.0f, 8.0f }, text);
+	delete[] text;
 }
 
-void draw_performance_metrics(VkCommandBuffer command_buffer) {
-	char *text = get_format_as_string("%.2f ms", perf_metrics.ms_per_frame);
-	draw_text(command_buffer, {0.01f, 0.01f}, text);
-	delete[] text;
+global_variable const char *draw_range_names[DRAW_RANGE_COUNT] = { "world", "text", "ui" };
+
+struct Draw_Range_Job {
+	Draw_Range range;
+	Game_State *game_state;
+	bool result;
+};
+
+// begins the secondary command buffer of a draw range and sets up the state every range needs; nothing is
+// inherited from the primary command buffer except the attachment formats of the main pass
+internal_function VkCommandBuffer begin_draw_range(Draw_Range range) {
+	// NOTE: resetting the whole pool is cheaper than resetting its command buffer
+	vkResetCommandPool(c.device, c.secondary_command_pools[c.current_frame][range], 0);
+	VkCommandBuffer command_buffer = c.secondary_command_buffers[c.current_frame][range];
+
+	VkCommandBufferInheritanceRenderingInfo rendering_info = {
+		.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_RENDERING_INFO,
+		.colorAttachmentCount = 1,
+		.pColorAttachmentFormats = &c.swapchain_image_format,
+		.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT,
+	};
+	VkCommandBufferInheritanceInfo inheritance_info = {
+		.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO,
+		.pNext = &rendering_info,
+	};
+	VkCommandBufferBeginInfo begin_info = {
+		.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+		.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT | VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT,
+		.pInheritanceInfo = &inheritance_info,
+	};
+	vkBeginCommandBuffer(command_buffer, &begin_info);
+
+	vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, c.graphics_pipeline[PIPELINE_DEFAULT]);
+
+	VkViewport viewport = {
+		.x = 0.0f, .y = 0.0f,
+		.width = static_cast<float>(c.swapchain_image_extent.width),
+		.height = static_cast<float>(c.swapchain_image_extent.height),
+		.minDepth = 0.0f, .maxDepth = 1.0f
+	};
+	vkCmdSetViewport(command_buffer, 0, 1, &viewport);
+
+	VkRect2D scissor = {
+		.offset = { 0, 0 },
+		.extent = c.swapchain_image_extent,
+	};
+	vkCmdSetScissor(command_buffer, 0, 1, &scissor);
+
+	bind_geometry_buffer(command_buffer);
+
+	// all pipelines share the set layouts, so the descriptor sets stay bound for the whole range
+	vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, c.pipeline_layout, 0, 1, &c.descriptor_set, 1, &camera_uniform_offset); // holds the camera uniforms
+	bind_bindless_textures(command_buffer, c.pipeline_layout);
+
+	return command_buffer;
+}
+
+// NOTE: rebuilt every frame, so the projection always matches the current aspect ratio and the camera can move
+internal_function void write_camera_uniforms(Game_State *game_state) {
+	real32 half_height = game_state->camera.half_height;
+	real32 aspect = (real32)c.swapchain_image_extent.width / (real32)c.swapchain_image_extent.height;
+	Vec2 position = game_state->camera.position;
+
+	Uniform_Buffer_Object ubo = {
+		.view = transpose(translate({ -position.x, -position.y, 0.0f })),
+		.proj = transpose(orthographic_projection(-aspect * half_height, aspect * half_height, -half_height, half_height, 0.1f, 2.0f)),
+	};
+
+	Frame_Allocation allocation;
+	bool result = frame_ring_allocate(sizeof(ubo), alignof(Uniform_Buffer_Object), &allocation);
+	if (!result) {
+		platform_log("Fatal: Failed to allocate the camera uniforms!\n");
+		assert(result);
+	}
+	memcpy(allocation.mapped, &ubo, sizeof(ubo));
+	camera_uniform_offset = allocation.offset;
+}
+
+internal_function void record_draw_range_job(void *data) {
+	Draw_Range_Job *job = static_cast<Draw_Range_Job *>(data);
+	Game_State *game_state = job->game_state;
+
+	VkCommandBuffer command_buffer = begin_draw_range(job->range);
+	uint32 gpu_scope = gpu_profiler_begin_scope(command_buffer, draw_range_names[job->range]);
+
+	switch (job->range) {
+		case DRAW_RANGE_WORLD: {
+			if (game_state->mode == MODE_PLAY) {
+				draw_game(command_buffer);
+				record_sprite_draws(command_buffer);
+			}
+			break;
+		}
+
+		case DRAW_RANGE_TEXT: {
+			record_text_draws(command_buffer);
+			break;
+		}
+
+		case DRAW_RANGE_UI: {
+			if (game_state->mode == MODE_MENU) {
+				draw_menu(command_buffer);
+			}
+			break;
+		}
+
+		default: {
+			break;
+		}
+	}
+
+	gpu_profiler_end_scope(command_buffer, gpu_scope);
+	job->result = vkEndCommandBuffer(command_buffer) == VK_SUCCESS;
+}
+
+internal_function void execute_draw_ranges(VkCommandBuffer command_buffer, void *user_data) {
+	Job_Counter *counter = static_cast<Job_Counter *>(user_data);
+
+	jobs_wait(counter);
+	vkCmdExecuteCommands(command_buffer, DRAW_RANGE_COUNT, c.secondary_command_buffers[c.current_frame]);
+}
+
+internal_function void read_back_frame(VkCommandBuffer command_buffer, void *user_data) {
+	Render_Resource *backbuffer = static_cast<Render_Resource *>(user_data);
+	record_offscreen_read_back(command_buffer, render_graph_get_image(*backbuffer));
 }
 
 void game_render(Game_State *game_state)
@@ -159,9 +258,11 @@ void game_render(Game_State *game_state)
 	//
 	// Don't render when game is minimized.
 	//
-	Window_Dimensions dimensions = {};
-	platform_get_window_dimensions(&dimensions);
-	if (dimensions.width == 0 || dimensions.height == 0) return;
+	if (!c.headless) {
+		Window_Dimensions dimensions = {};
+		platform_get_window_dimensions(&dimensions);
+		if (dimensions.width == 0 || dimensions.height == 0) return;
+	}
 
 	// 
 	// Wait until current frame is not in use.
@@ -171,91 +272,186 @@ void game_render(Game_State *game_state)
 	//
 	// Recreate the swapchain if the swapchain is outdated (resizing or minimizing window).
 	//
-	static bool swapchain_outdated = false;
-	if (swapchain_outdated) {
-		recreate_swapchain();
-		swapchain_outdated = false;
+	// NOTE: however many resize events came in since the last frame, they end up in one recreation at the latest
+	// size. Nothing waits for the gpu here, the old swapchain is retired and destroyed frames later.
+	if (!c.headless) {
+		Window_Dimensions dimensions = {};
+		platform_get_window_dimensions(&dimensions);
+		if (dimensions.width != swapchain_window_dimensions.width || dimensions.height != swapchain_window_dimensions.height) {
+			if (swapchain_window_dimensions.width != 0) swapchain_outdated = true; // the first frame uses the swapchain from init
+			swapchain_window_dimensions = dimensions;
+		}
+
+		if (swapchain_outdated) {
+			recreate_swapchain();
+			swapchain_outdated = false;
+		}
 	}
 
 	//
 	// Acquire an image from the swapchain.
 	//
 	uint32 image_index;
-	VkResult result = vkAcquireNextImageKHR(c.device, c.swapchain, UINT64_MAX, c.image_available_semaphores[c.current_frame], VK_NULL_HANDLE, &image_index);
-	if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR) {
-		swapchain_outdated = true;
-		return;
+	VkResult result = VK_SUCCESS;
+	if (c.headless) {
+		// the offscreen ring has one image per frame in flight, waiting for the frame above already freed it
+		image_index = c.current_frame;
 	}
-	else if (result != VK_SUCCESS) {
-		platform_log("Fatal: Failed to acquire the next image!\n");
-		assert(VK_SUCCESS == result);
+	else {
+		result = vkAcquireNextImageKHR(c.device, c.swapchain, UINT64_MAX, c.image_available_semaphores[c.current_frame], VK_NULL_HANDLE, &image_index);
+		if (result == VK_ERROR_OUT_OF_DATE_KHR) {
+			swapchain_outdated = true;
+			return;
+		}
+		else if (result == VK_SUBOPTIMAL_KHR) {
+			// the image is acquired and the semaphore will be signaled, so this frame still renders and presents
+			swapchain_outdated = true;
+		}
+		else if (result != VK_SUCCESS) {
+			platform_log("Fatal: Failed to acquire the next image!\n");
+			assert(VK_SUCCESS == result);
+		}
 	}
 
+	// NOTE: only a frame that gets submitted counts. A frame that bailed out above reuses its fence slot, counting
+	// it would let the deletion queue free what the frame in flight on the other slots still uses. Whatever was
+	// retired above (the old swapchain) is stamped with the last submitted frame, the one that used it last.
+	++c.frame_number;
+
+	// everything the frames up to this one's last use released can go now
+	deletion_queue_collect();
+	frame_ring_begin_frame();
+
 	// 
 	// Draw. (Record command buffer that draws image.)
 	//
-	VkClearValue clear_color = { {{0.05f, 0.3f, 0.3f, 1.0f}} };
-	VkCommandBuffer command_buffer = begin_render_pass(c.main_pass, &clear_color, image_index);
+	VkCommandBuffer command_buffer = begin_command_buffer();
 
-	vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, c.graphics_pipeline[0]);
+	// the fence above retired this frame's last timestamps, they go into perf_metrics now
+	gpu_profiler_begin_frame(command_buffer);
 
-	VkViewport viewport = {
-		.x = 0.0f, .y = 0.0f,
-		.width = static_cast<float>(c.swapchain_image_extent.width),
-		.height = static_cast<float>(c.swapchain_image_extent.height),
-		.minDepth = 0.0f, .maxDepth = 1.0f
-	};
-	vkCmdSetViewport(command_buffer, 0, 1, &viewport);
+	// send off what was streamed since the last frame and take over everything the transfer queue finished
+	// (outside of the render pass)
+	bool flushed = upload_flush();
+	if (!flushed) {
+		platform_log("Fatal: Failed to flush the uploads!\n");
+		assert(flushed);
+	}
+	uint64 upload_value = upload_record_acquires(command_buffer);
 
-	VkRect2D scissor = {
-		.offset = { 0, 0 },
-		.extent = c.swapchain_image_extent,
-	};
-	vkCmdSetScissor(command_buffer, 0, 1, &scissor);
+	if (game_state->mode != MODE_PLAY && game_state->mode != MODE_MENU) {
+		platform_log("This mode is not recognized as a mode the game could be in!");
+	}
 
-	switch (game_state->mode) {
-		case MODE_PLAY: {
-			draw_game(command_buffer, game_state);
-			break;
-		}
+	write_camera_uniforms(game_state);
 
-		case MODE_MENU: {
-			draw_menu(command_buffer);
-			break;
-		}
+	// sprites and text are queued up front, their ranges turn them into one instanced draw each (per font for text)
+	sprites_begin_frame();
+	text_begin_frame();
+	if (game_state->mode == MODE_PLAY) {
+		draw_game_sprites(game_state);
+	}
+	// NOTE: the timings differ from run to run, headless frames have to stay the same so -out images can be diffed
+	if (!c.headless) {
+		draw_performance_metrics();
+	}
 
-		default: {
-			platform_log("This mode is not recognized as a mode the game could be in!");
-			break;
-		}
+	// record all draw ranges in parallel, the primary command buffer only executes them in order
+	Draw_Range_Job range_jobs[DRAW_RANGE_COUNT];
+	Job_Counter counter = {};
+	for (uint32 range = 0; range < DRAW_RANGE_COUNT; ++range) {
+		range_jobs[range] = { static_cast<Draw_Range>(range), game_state, false };
+		jobs_submit(record_draw_range_job, &range_jobs[range], &counter);
+	}
+
+	// describe the frame, the graph takes care of layouts and barriers
+	render_graph_begin();
+
+	VkImageLayout final_layout = c.headless ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+	Render_Resource backbuffer = render_graph_import_image(c.swapchain_images[image_index], c.swapchain_image_views[image_index], c.swapchain_image_format, c.swapchain_image_extent, final_layout);
+
+	// new glyphs of this frame's text are copied into the atlas before anything samples it
+	Render_Resource glyph_atlas = add_glyph_upload_pass();
+
+	VkClearValue clear_color = { {{0.05f, 0.3f, 0.3f, 1.0f}} };
+	Render_Pass main_pass = render_graph_add_pass("main", execute_draw_ranges, &counter, RENDER_PASS_SECONDARY_CONTENTS);
+	render_graph_write_color(main_pass, backbuffer, &clear_color);
+	if (glyph_atlas != INVALID_RENDER_RESOURCE) render_graph_read(main_pass, glyph_atlas, RENDER_ACCESS_SAMPLED);
+
+	if (c.headless && offscreen_read_back_enabled()) {
+		Render_Pass read_back_pass = render_graph_add_pass("read back", read_back_frame, &backbuffer, RENDER_PASS_NO_RENDERING | RENDER_PASS_SIDE_EFFECTS);
+		render_graph_read(read_back_pass, backbuffer, RENDER_ACCESS_TRANSFER_SRC);
 	}
 
-	//vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, c.graphics_pipeline[1]);
-	draw_performance_metrics(command_buffer);
+	bool compiled = render_graph_compile();
+	if (!compiled) {
+		platform_log("Fatal: Failed to compile the render graph!\n");
+		assert(compiled);
+	}
+	render_graph_execute(command_buffer);
+
+	// NOTE: the main pass waits for the recording jobs, this only matters if it never ran
+	jobs_wait(&counter);
+	for (uint32 range = 0; range < DRAW_RANGE_COUNT; ++range) {
+		if (!range_jobs[range].result) {
+			platform_log("Fatal: Failed to record draw range %u!\n", range);
+			assert(range_jobs[range].result);
+		}
+	}
 
-	end_render_pass(command_buffer);
+	gpu_profiler_end_frame(command_buffer);
+	end_command_buffer(command_buffer);
 
 	//
 	// Submit the draw command.
 	// 
-	VkSemaphore wait_semaphores[] = { c.image_available_semaphores[c.current_frame] };
+	// NOTE: the upload timeline value has already been reached, the wait only orders the acquire barriers
+	// after the release on the transfer queue
+	VkSemaphore wait_semaphores[2];
+	uint64 wait_values[2];
+	VkPipelineStageFlags wait_stages[2];
+	uint32 wait_count = 0;
+	if (!c.headless) {
+		wait_semaphores[wait_count] = c.image_available_semaphores[c.current_frame];
+		wait_values[wait_count] = 0;
+		wait_stages[wait_count] = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+		++wait_count;
+	}
+	if (upload_value) {
+		wait_semaphores[wait_count] = upload_get_timeline_semaphore();
+		wait_values[wait_count] = upload_value;
+		wait_stages[wait_count] = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+		++wait_count;
+	}
 	VkSemaphore signal_semaphores[] = { c.render_finished_semaphores[c.current_frame] };
-	VkPipelineStageFlags wait_stages[] = { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT };
+	VkTimelineSemaphoreSubmitInfo timeline_info = {
+		.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO,
+		.waitSemaphoreValueCount = wait_count,
+		.pWaitSemaphoreValues = wait_values,
+	};
 	VkSubmitInfo submit_info = {
 		.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
-		.waitSemaphoreCount = 1,
+		.pNext = &timeline_info,
+		.waitSemaphoreCount = wait_count,
 		.pWaitSemaphores = wait_semaphores,
 		.pWaitDstStageMask = wait_stages,
 		.commandBufferCount = 1,
 		.pCommandBuffers = &c.command_buffers[c.current_frame],
-		.signalSemaphoreCount = 1,
+		.signalSemaphoreCount = c.headless ? 0u : 1u, // nothing presents in headless
 		.pSignalSemaphores = signal_semaphores
 	};
+	vkResetFences(c.device, 1, &c.in_flight_fences[c.current_frame]);
 	result = vkQueueSubmit(c.graphics_queue, 1, &submit_info, c.in_flight_fences[c.current_frame]);
 	if (VK_SUCCESS != result) {
 		platform_log("Fatal: Failed to submit to queue!\n");
 		assert(VK_SUCCESS == result);
 	}
+	last_submitted_frame = c.current_frame;
+
+	if (c.headless) {
+		c.current_frame = (c.current_frame + 1) % c.frames_in_flight;
+		return;
+	}
 
 	//
 	// Present the image.
@@ -271,13 +467,23 @@ void game_render(Game_State *game_state)
 	};
 	result = vkQueuePresentKHR(c.present_queue, &present_info);
 	if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR) {
-		swapchain_outdated = true;
-		return;
+		swapchain_outdated = true; // the frame was submitted either way, so it still counts
 	}
 	else if (result != VK_SUCCESS) {
 		platform_log("Fatal: Failed to present!\n");
 		assert(VK_SUCCESS == result);
 	}
 
-	c.current_frame = (c.current_frame + 1) % MAX_FRAMES_IN_FLIGHT;
+	c.current_frame = (c.current_frame + 1) % c.frames_in_flight;
+}
+
+const uint8 *renderer_read_back_last_frame(uint32 *width, uint32 *height) {
+	if (!c.headless || !offscreen_read_back_enabled() || last_submitted_frame == NO_FRAME_SUBMITTED) return 0;
+
+	// NOTE: no reset, the next frame that uses this fence waits on it again before resetting it
+	vkWaitForFences(c.device, 1, &c.in_flight_fences[last_submitted_frame], VK_TRUE, UINT64_MAX);
+
+	*width = c.swapchain_image_extent.width;
+	*height = c.swapchain_image_extent.height;
+	return get_offscreen_pixels(last_submitted_frame);
 }
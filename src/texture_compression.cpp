@@ -0,0 +1,592 @@
+#include "texture_compression.hpp"
+
+#include "mipmaps.hpp"
+
+#include <lib/stb_image.h>
+
+#include <math.h>
+#include <string.h>
+
+#include <vector>
+
+//
+// Internal
+//
+
+constexpr uint32 TEXTURE_FILE_MAGIC = 0x58455443; // "CTEX"
+constexpr uint32 TEXTURE_FILE_VERSION = 1;
+constexpr uint32 BLOCK_TEXELS = 16; // 4x4
+
+// NOTE: a cooked texture is the header and then level_count levels of the encoded mip chain
+struct Texture_File_Header {
+	uint32 magic;
+	uint32 version;
+	uint32 encoding; // a Texture_Encoding
+	uint32 width;
+	uint32 height;
+	uint32 level_count;
+};
+
+// the weights of mode 6's 4 bit indices, out of 64
+global_variable const uint32 bc7_weights[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+struct Bit_Stream {
+	uint8 *bytes;
+	uint32 position;
+};
+
+internal_function void write_bits(Bit_Stream *stream, uint32 value, uint32 bit_count) {
+	for (uint32 i = 0; i < bit_count; ++i, ++stream->position) {
+		if ((value >> i) & 1) stream->bytes[stream->position >> 3] |= static_cast<uint8>(1 << (stream->position & 7));
+	}
+}
+
+internal_function uint32 read_bits(Bit_Stream *stream, uint32 bit_count) {
+	uint32 value = 0;
+	for (uint32 i = 0; i < bit_count; ++i, ++stream->position) {
+		value |= ((stream->bytes[stream->position >> 3] >> (stream->position & 7)) & 1u) << i;
+	}
+	return value;
+}
+
+internal_function uint32 get_block_size(Texture_Encoding encoding) {
+	return encoding == TEXTURE_ENCODING_BC1 ? 8 : 16;
+}
+
+internal_function real32 clamp_255(real32 value) {
+	return value < 0.0f ? 0.0f : (value > 255.0f ? 255.0f : value);
+}
+
+// NOTE: the endpoints are the two ends of the line through the texels' mean along their principal axis (a few
+// rounds of power iteration on the covariance). Bounding box corners would miss every block where one channel
+// falls while another rises. Only texels in mask count.
+internal_function void find_endpoints(const uint8 *texels, uint32 mask, uint32 channel_count, real32 *endpoint0, real32 *endpoint1) {
+	real32 mean[4] = {};
+	uint32 count = 0;
+	for (uint32 i = 0; i < BLOCK_TEXELS; ++i) {
+		if (!(mask & (1 << i))) continue;
+		for (uint32 channel = 0; channel < channel_count; ++channel) mean[channel] += texels[i * 4 + channel];
+		++count;
+	}
+	for (uint32 channel = 0; channel < channel_count; ++channel) mean[channel] /= count;
+
+	real32 covariance[4][4] = {};
+	for (uint32 i = 0; i < BLOCK_TEXELS; ++i) {
+		if (!(mask & (1 << i))) continue;
+		for (uint32 row = 0; row < channel_count; ++row) {
+			for (uint32 column = 0; column < channel_count; ++column) {
+				covariance[row][column] += (texels[i * 4 + row] - mean[row]) * (texels[i * 4 + column] - mean[column]);
+			}
+		}
+	}
+
+	// starting from the row of the channel that varies most never starts orthogonal to the axis
+	uint32 largest = 0;
+	for (uint32 channel = 1; channel < channel_count; ++channel) {
+		if (covariance[channel][channel] > covariance[largest][largest]) largest = channel;
+	}
+	real32 axis[4] = {};
+	for (uint32 channel = 0; channel < channel_count; ++channel) axis[channel] = covariance[largest][channel];
+
+	for (uint32 iteration = 0; iteration < 8; ++iteration) {
+		real32 next[4] = {};
+		real32 length = 0.0f;
+		for (uint32 row = 0; row < channel_count; ++row) {
+			for (uint32 column = 0; column < channel_count; ++column) next[row] += covariance[row][column] * axis[column];
+			length += next[row] * next[row];
+		}
+		if (length < 1e-12f) break; // every texel is the same, the axis doesn't matter
+		length = sqrtf(length);
+		for (uint32 channel = 0; channel < channel_count; ++channel) axis[channel] = next[channel] / length;
+	}
+
+	real32 t_min = 0.0f, t_max = 0.0f;
+	for (uint32 i = 0; i < BLOCK_TEXELS; ++i) {
+		if (!(mask & (1 << i))) continue;
+		real32 t = 0.0f;
+		for (uint32 channel = 0; channel < channel_count; ++channel) t += (texels[i * 4 + channel] - mean[channel]) * axis[channel];
+		if (t < t_min) t_min = t;
+		if (t > t_max) t_max = t;
+	}
+
+	for (uint32 channel = 0; channel < channel_count; ++channel) {
+		endpoint0[channel] = clamp_255(mean[channel] + t_min * axis[channel]);
+		endpoint1[channel] = clamp_255(mean[channel] + t_max * axis[channel]);
+	}
+}
+
+internal_function uint32 get_distance(const uint8 *a, const uint8 *b, uint32 channel_count) {
+	uint32 distance = 0;
+	for (uint32 channel = 0; channel < channel_count; ++channel) {
+		int32 difference = static_cast<int32>(a[channel]) - static_cast<int32>(b[channel]);
+		distance += static_cast<uint32>(difference * difference);
+	}
+	return distance;
+}
+
+//
+// BC1 colors, also the color half of BC3
+//
+
+internal_function uint16 pack_565(const real32 *color) {
+	uint32 r = static_cast<uint32>(color[0] * 31.0f / 255.0f + 0.5f);
+	uint32 g = static_cast<uint32>(color[1] * 63.0f / 255.0f + 0.5f);
+	uint32 b = static_cast<uint32>(color[2] * 31.0f / 255.0f + 0.5f);
+	return static_cast<uint16>((r << 11) | (g << 5) | b);
+}
+
+internal_function void unpack_565(uint16 packed, uint8 *color) {
+	uint32 r = (packed >> 11) & 31, g = (packed >> 5) & 63, b = packed & 31;
+	color[0] = static_cast<uint8>((r << 3) | (r >> 2));
+	color[1] = static_cast<uint8>((g << 2) | (g >> 4));
+	color[2] = static_cast<uint8>((b << 3) | (b >> 2));
+	color[3] = 255;
+}
+
+// c0 > c1 (or always, in BC3) is four colors; otherwise three and transparent black
+internal_function void get_bc1_palette(uint16 c0, uint16 c1, bool four_colors, uint8 palette[4][4]) {
+	unpack_565(c0, palette[0]);
+	unpack_565(c1, palette[1]);
+	for (uint32 channel = 0; channel < 3; ++channel) {
+		uint32 a = palette[0][channel], b = palette[1][channel];
+		if (four_colors) {
+			palette[2][channel] = static_cast<uint8>((2 * a + b) / 3);
+			palette[3][channel] = static_cast<uint8>((a + 2 * b) / 3);
+		}
+		else {
+			palette[2][channel] = static_cast<uint8>((a + b) / 2);
+			palette[3][channel] = 0;
+		}
+	}
+	palette[2][3] = 255;
+	palette[3][3] = four_colors ? 255 : 0;
+}
+
+// punch_through: texels with alpha below 128 become transparent, only BC1 has that
+internal_function void encode_bc1_colors(const uint8 *texels, bool punch_through, uint8 *block) {
+	uint32 opaque_mask = 0;
+	for (uint32 i = 0; i < BLOCK_TEXELS; ++i) {
+		if (!punch_through || texels[i * 4 + 3] >= 128) opaque_mask |= 1 << i;
+	}
+	if (opaque_mask == 0) {
+		memset(block, 0, 4);
+		memset(block + 4, 0xFF, 4);
+		return;
+	}
+	bool transparent = opaque_mask != 0xFFFF;
+
+	real32 endpoint0[3], endpoint1[3];
+	find_endpoints(texels, opaque_mask, 3, endpoint0, endpoint1);
+	uint16 c0 = pack_565(endpoint0);
+	uint16 c1 = pack_565(endpoint1);
+	if (transparent ? c0 > c1 : c0 < c1) {
+		uint16 swap = c0;
+		c0 = c1;
+		c1 = swap;
+	}
+
+	// NOTE: c0 == c1 decodes as three colors in BC1, index 0 is c0 either way
+	bool four_colors = c0 > c1;
+	uint8 palette[4][4];
+	get_bc1_palette(c0, c1, four_colors, palette);
+
+	uint32 indices = 0;
+	for (uint32 i = 0; i < BLOCK_TEXELS; ++i) {
+		uint32 best_index = 3;
+		if (opaque_mask & (1 << i)) {
+			uint32 best_distance = UINT32_MAX;
+			for (uint32 index = 0; index < (four_colors ? 4u : 3u); ++index) {
+				uint32 distance = get_distance(texels + i * 4, palette[index], 3);
+				if (distance < best_distance) {
+					best_distance = distance;
+					best_index = index;
+				}
+			}
+		}
+		indices |= best_index << (i * 2);
+	}
+
+	block[0] = static_cast<uint8>(c0);
+	block[1] = static_cast<uint8>(c0 >> 8);
+	block[2] = static_cast<uint8>(c1);
+	block[3] = static_cast<uint8>(c1 >> 8);
+	for (uint32 i = 0; i < 4; ++i) block[4 + i] = static_cast<uint8>(indices >> (i * 8));
+}
+
+// writes color and, for BC1, alpha; BC3 overwrites alpha afterwards
+internal_function void decode_bc1_colors(const uint8 *block, bool always_four_colors, uint8 *texels) {
+	uint16 c0 = static_cast<uint16>(block[0] | (block[1] << 8));
+	uint16 c1 = static_cast<uint16>(block[2] | (block[3] << 8));
+	uint8 palette[4][4];
+	get_bc1_palette(c0, c1, always_four_colors || c0 > c1, palette);
+
+	uint32 indices = block[4] | (block[5] << 8) | (block[6] << 16) | (static_cast<uint32>(block[7]) << 24);
+	for (uint32 i = 0; i < BLOCK_TEXELS; ++i) {
+		memcpy(texels + i * 4, palette[(indices >> (i * 2)) & 3], 4);
+	}
+}
+
+//
+// BC4 alpha, the alpha half of BC3
+//
+
+// a0 > a1 is eight steps from a0 to a1; otherwise six steps, 0 and 255
+internal_function void get_bc4_palette(uint8 a0, uint8 a1, uint8 palette[8]) {
+	palette[0] = a0;
+	palette[1] = a1;
+	if (a0 > a1) {
+		for (uint32 i = 2; i < 8; ++i) palette[i] = static_cast<uint8>(((8 - i) * a0 + (i - 1) * a1) / 7);
+	}
+	else {
+		for (uint32 i = 2; i < 6; ++i) palette[i] = static_cast<uint8>(((6 - i) * a0 + (i - 1) * a1) / 5);
+		palette[6] = 0;
+		palette[7] = 255;
+	}
+}
+
+internal_function void encode_bc4_alpha(const uint8 *texels, uint8 *block) {
+	uint8 a_min = 255, a_max = 0;
+	for (uint32 i = 0; i < BLOCK_TEXELS; ++i) {
+		uint8 alpha = texels[i * 4 + 3];
+		if (alpha < a_min) a_min = alpha;
+		if (alpha > a_max) a_max = alpha;
+	}
+
+	uint8 palette[8];
+	get_bc4_palette(a_max, a_min, palette);
+
+	uint64 indices = 0;
+	for (uint32 i = 0; i < BLOCK_TEXELS && a_max > a_min; ++i) {
+		uint32 best_index = 0, best_distance = UINT32_MAX;
+		for (uint32 index = 0; index < 8; ++index) {
+			uint32 distance = get_distance(texels + i * 4 + 3, palette + index, 1);
+			if (distance < best_distance) {
+				best_distance = distance;
+				best_index = index;
+			}
+		}
+		indices |= static_cast<uint64>(best_index) << (i * 3);
+	}
+
+	block[0] = a_max;
+	block[1] = a_min;
+	for (uint32 i = 0; i < 6; ++i) block[2 + i] = static_cast<uint8>(indices >> (i * 8));
+}
+
+internal_function void decode_bc4_alpha(const uint8 *block, uint8 *texels) {
+	uint8 palette[8];
+	get_bc4_palette(block[0], block[1], palette);
+
+	uint64 indices = 0;
+	for (uint32 i = 0; i < 6; ++i) indices |= static_cast<uint64>(block[2 + i]) << (i * 8);
+	for (uint32 i = 0; i < BLOCK_TEXELS; ++i) {
+		texels[i * 4 + 3] = palette[(indices >> (i * 3)) & 7];
+	}
+}
+
+//
+// BC7 mode 6: 7 mode bits, RGBA endpoints of 7 bits each, one p bit per endpoint that becomes the 8th bit of all
+// its channels, then 4 bit indices (the first texel's top bit is implied 0)
+//
+
+// the 7 bit channels and the p bit that come closest to endpoint
+internal_function void quantize_bc7_endpoint(const real32 *endpoint, uint32 *channels, uint32 *p_bit) {
+	real32 best_error = 1e30f;
+	for (uint32 p = 0; p < 2; ++p) {
+		uint32 candidate[4];
+		real32 error = 0.0f;
+		for (uint32 channel = 0; channel < 4; ++channel) {
+			real32 value = (endpoint[channel] - p) * 0.5f + 0.5f;
+			candidate[channel] = value < 0.0f ? 0 : (value > 127.0f ? 127 : static_cast<uint32>(value));
+			real32 difference = static_cast<real32>((candidate[channel] << 1) | p) - endpoint[channel];
+			error += difference * difference;
+		}
+		if (error < best_error) {
+			best_error = error;
+			memcpy(channels, candidate, sizeof(candidate));
+			*p_bit = p;
+		}
+	}
+}
+
+internal_function void get_bc7_palette(const uint32 *channels0, uint32 p0, const uint32 *channels1, uint32 p1, uint8 palette[16][4]) {
+	for (uint32 channel = 0; channel < 4; ++channel) {
+		uint32 a = (channels0[channel] << 1) | p0;
+		uint32 b = (channels1[channel] << 1) | p1;
+		for (uint32 index = 0; index < 16; ++index) {
+			palette[index][channel] = static_cast<uint8>(((64 - bc7_weights[index]) * a + bc7_weights[index] * b + 32) >> 6);
+		}
+	}
+}
+
+internal_function void encode_bc7_mode6(const uint8 *texels, uint8 *block) {
+	real32 endpoint0[4], endpoint1[4];
+	find_endpoints(texels, 0xFFFF, 4, endpoint0, endpoint1);
+
+	uint32 channels0[4], channels1[4], p0, p1;
+	quantize_bc7_endpoint(endpoint0, channels0, &p0);
+	quantize_bc7_endpoint(endpoint1, channels1, &p1);
+
+	uint8 palette[16][4];
+	get_bc7_palette(channels0, p0, channels1, p1, palette);
+
+	uint32 indices[BLOCK_TEXELS];
+	for (uint32 i = 0; i < BLOCK_TEXELS; ++i) {
+		uint32 best_distance = UINT32_MAX;
+		for (uint32 index = 0; index < 16; ++index) {
+			uint32 distance = get_distance(texels + i * 4, palette[index], 4);
+			if (distance < best_distance) {
+				best_distance = distance;
+				indices[i] = index;
+			}
+		}
+	}
+
+	// the first index has no top bit, swapping the endpoints mirrors the indices (the weights are symmetric)
+	if (indices[0] & 8) {
+		for (uint32 channel = 0; channel < 4; ++channel) {
+			uint32 swap = channels0[channel];
+			channels0[channel] = channels1[channel];
+			channels1[channel] = swap;
+		}
+		uint32 swap = p0;
+		p0 = p1;
+		p1 = swap;
+		for (uint32 i = 0; i < BLOCK_TEXELS; ++i) indices[i] = 15 - indices[i];
+	}
+
+	memset(block, 0, 16);
+	Bit_Stream stream = { block, 0 };
+	write_bits(&stream, 1 << 6, 7);
+	for (uint32 channel = 0; channel < 4; ++channel) {
+		write_bits(&stream, channels0[channel], 7);
+		write_bits(&stream, channels1[channel], 7);
+	}
+	write_bits(&stream, p0, 1);
+	write_bits(&stream, p1, 1);
+	for (uint32 i = 0; i < BLOCK_TEXELS; ++i) {
+		write_bits(&stream, indices[i], i == 0 ? 3 : 4);
+	}
+}
+
+internal_function bool decode_bc7_mode6(const uint8 *block, uint8 *texels) {
+	if ((block[0] & 0x7F) != (1 << 6)) {
+		for (uint32 i = 0; i < BLOCK_TEXELS; ++i) {
+			texels[i * 4 + 0] = 255;
+			texels[i * 4 + 1] = 0;
+			texels[i * 4 + 2] = 255;
+			texels[i * 4 + 3] = 255;
+		}
+		return false;
+	}
+
+	Bit_Stream stream = { const_cast<uint8 *>(block), 7 };
+	uint32 channels0[4], channels1[4];
+	for (uint32 channel = 0; channel < 4; ++channel) {
+		channels0[channel] = read_bits(&stream, 7);
+		channels1[channel] = read_bits(&stream, 7);
+	}
+	uint32 p0 = read_bits(&stream, 1);
+	uint32 p1 = read_bits(&stream, 1);
+
+	uint8 palette[16][4];
+	get_bc7_palette(channels0, p0, channels1, p1, palette);
+	for (uint32 i = 0; i < BLOCK_TEXELS; ++i) {
+		memcpy(texels + i * 4, palette[read_bits(&stream, i == 0 ? 3 : 4)], 4);
+	}
+	return true;
+}
+
+//
+// Exported
+//
+
+bool parse_texture_encoding(const char *name, Texture_Encoding *encoding) {
+	const char *names[TEXTURE_ENCODING_COUNT] = { "rgba8", "bc1", "bc3", "bc7" };
+	for (uint32 i = 0; i < TEXTURE_ENCODING_COUNT; ++i) {
+		if (strcmp(name, names[i]) == 0) {
+			*encoding = static_cast<Texture_Encoding>(i);
+			return true;
+		}
+	}
+	return false;
+}
+
+size_t get_encoded_level_size(Texture_Encoding encoding, uint32 width, uint32 height) {
+	if (encoding == TEXTURE_ENCODING_RGBA8) return static_cast<size_t>(width) * height * 4;
+	return static_cast<size_t>((width + 3) / 4) * ((height + 3) / 4) * get_block_size(encoding);
+}
+
+void encode_texture_level(Texture_Encoding encoding, const uint8 *rgba, uint32 width, uint32 height, uint8 *blocks) {
+	if (encoding == TEXTURE_ENCODING_RGBA8) {
+		memcpy(blocks, rgba, get_encoded_level_size(encoding, width, height));
+		return;
+	}
+
+	uint32 block_size = get_block_size(encoding);
+	for (uint32 block_y = 0; block_y < height; block_y += 4) {
+		for (uint32 block_x = 0; block_x < width; block_x += 4, blocks += block_size) {
+			uint8 texels[BLOCK_TEXELS * 4];
+			for (uint32 y = 0; y < 4; ++y) {
+				uint32 source_y = block_y + y < height ? block_y + y : height - 1;
+				for (uint32 x = 0; x < 4; ++x) {
+					uint32 source_x = block_x + x < width ? block_x + x : width - 1;
+					memcpy(texels + (y * 4 + x) * 4, rgba + (static_cast<size_t>(source_y) * width + source_x) * 4, 4);
+				}
+			}
+
+			switch (encoding) {
+			case TEXTURE_ENCODING_BC1:
+				encode_bc1_colors(texels, true, blocks);
+				break;
+			case TEXTURE_ENCODING_BC3:
+				encode_bc4_alpha(texels, blocks);
+				encode_bc1_colors(texels, false, blocks + 8);
+				break;
+			case TEXTURE_ENCODING_BC7:
+				encode_bc7_mode6(texels, blocks);
+				break;
+			default:
+				break;
+			}
+		}
+	}
+}
+
+bool decode_texture_level(Texture_Encoding encoding, const uint8 *blocks, uint32 width, uint32 height, uint8 *rgba) {
+	if (encoding == TEXTURE_ENCODING_RGBA8) {
+		memcpy(rgba, blocks, get_encoded_level_size(encoding, width, height));
+		return true;
+	}
+
+	bool result = true;
+	uint32 block_size = get_block_size(encoding);
+	for (uint32 block_y = 0; block_y < height; block_y += 4) {
+		for (uint32 block_x = 0; block_x < width; block_x += 4, blocks += block_size) {
+			uint8 texels[BLOCK_TEXELS * 4];
+			switch (encoding) {
+			case TEXTURE_ENCODING_BC1:
+				decode_bc1_colors(blocks, false, texels);
+				break;
+			case TEXTURE_ENCODING_BC3:
+				decode_bc1_colors(blocks + 8, true, texels);
+				decode_bc4_alpha(blocks, texels);
+				break;
+			case TEXTURE_ENCODING_BC7:
+				result = decode_bc7_mode6(blocks, texels) && result;
+				break;
+			default:
+				break;
+			}
+
+			for (uint32 y = 0; y < 4 && block_y + y < height; ++y) {
+				for (uint32 x = 0; x < 4 && block_x + x < width; ++x) {
+					memcpy(rgba + ((static_cast<size_t>(block_y) + y) * width + block_x + x) * 4, texels + (y * 4 + x) * 4, 4);
+				}
+			}
+		}
+	}
+	return result;
+}
+
+bool cook_texture(const char *image_path, const char *cooked_path, Texture_Encoding encoding) {
+	int width, height, nr_channels;
+	stbi_uc *pixels = stbi_load(image_path, &width, &height, &nr_channels, STBI_rgb_alpha);
+	if (!pixels) {
+		platform_log("Failed to load the texture '%s'!\n", image_path);
+		return false;
+	}
+
+	//
+	// mip chain in RGBA8, every level gets encoded on its own
+	//
+	uint32 level_count = get_mip_level_count(width, height);
+	std::vector<uint8> mip_chain(get_mip_chain_size(width, height, 1, level_count));
+	memcpy(mip_chain.data(), pixels, static_cast<size_t>(width) * height * 4);
+	stbi_image_free(pixels);
+	generate_mip_chain(mip_chain.data(), width, height, 1, level_count, true);
+
+	size_t levels_size = 0;
+	for (uint32 level = 0; level < level_count; ++level) {
+		levels_size += get_encoded_level_size(encoding, width >> level ? width >> level : 1, height >> level ? height >> level : 1);
+	}
+	size_t file_size = sizeof(Texture_File_Header) + levels_size;
+	if (file_size > UINT32_MAX) {
+		platform_log("The texture '%s' is too big for one file!\n", image_path);
+		return false;
+	}
+
+	Texture_File_Header header = {
+		.magic = TEXTURE_FILE_MAGIC,
+		.version = TEXTURE_FILE_VERSION,
+		.encoding = static_cast<uint32>(encoding),
+		.width = static_cast<uint32>(width),
+		.height = static_cast<uint32>(height),
+		.level_count = level_count,
+	};
+	std::vector<uint8> file(file_size);
+	memcpy(file.data(), &header, sizeof(header));
+
+	const uint8 *source = mip_chain.data();
+	uint8 *destination = file.data() + sizeof(header);
+	for (uint32 level = 0; level < level_count; ++level) {
+		uint32 level_width = width >> level ? width >> level : 1;
+		uint32 level_height = height >> level ? height >> level : 1;
+		encode_texture_level(encoding, source, level_width, level_height, destination);
+		source += static_cast<size_t>(level_width) * level_height * 4;
+		destination += get_encoded_level_size(encoding, level_width, level_height);
+	}
+
+	bool result = platform_write_file(cooked_path, file.data(), static_cast<uint32>(file_size));
+	if (!result) {
+		platform_log("Failed to write the texture '%s'!\n", cooked_path);
+		return false;
+	}
+
+	platform_log("Cooked %dx%d with %u levels into %u KB (%u KB as RGBA8): %s\n", width, height, level_count, static_cast<uint32>(levels_size / 1024), static_cast<uint32>(mip_chain.size() / 1024), cooked_path);
+	return true;
+}
+
+bool read_cooked_texture(const char *cooked_path, Cooked_Texture *texture) {
+	File_Asset file = {};
+	uint32 size = platform_read_file(cooked_path, &file);
+	if (size < sizeof(Texture_File_Header)) {
+		if (size > 0) platform_free_file(&file);
+		platform_log("Failed to read the texture '%s'!\n", cooked_path);
+		return false;
+	}
+
+	Texture_File_Header header;
+	memcpy(&header, file.data, sizeof(header));
+
+	bool valid = header.magic == TEXTURE_FILE_MAGIC &&
+		header.version == TEXTURE_FILE_VERSION &&
+		header.encoding < TEXTURE_ENCODING_COUNT &&
+		header.width > 0 && header.height > 0 &&
+		header.level_count > 0 && header.level_count <= get_mip_level_count(header.width, header.height);
+	size_t levels_size = 0;
+	for (uint32 level = 0; valid && level < header.level_count; ++level) {
+		uint32 level_width = header.width >> level ? header.width >> level : 1;
+		uint32 level_height = header.height >> level ? header.height >> level : 1;
+		levels_size += get_encoded_level_size(static_cast<Texture_Encoding>(header.encoding), level_width, level_height);
+	}
+	if (!valid || size != sizeof(header) + levels_size) {
+		platform_log("'%s' is not a cooked texture of this version!\n", cooked_path);
+		platform_free_file(&file);
+		return false;
+	}
+
+	texture->encoding = static_cast<Texture_Encoding>(header.encoding);
+	texture->width = header.width;
+	texture->height = header.height;
+	texture->level_count = header.level_count;
+	texture->levels = reinterpret_cast<const uint8 *>(file.data) + sizeof(header);
+	texture->levels_size = levels_size;
+	texture->file = file;
+	return true;
+}
+
+void free_cooked_texture(Cooked_Texture *texture) {
+	platform_free_file(&texture->file);
+	*texture = {};
+}
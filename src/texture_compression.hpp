@@ -0,0 +1,52 @@
+#ifndef TEXTURE_COMPRESSION_H
+#define TEXTURE_COMPRESSION_H
+
+#include "types.hpp"
+#include "platform.hpp"
+
+#include <stddef.h>
+
+// NOTE: block compressed textures stay compressed in video memory, the gpu decodes them while sampling. BC1 is
+// 8 bytes per 4x4 texels (RGB and one bit of alpha), BC3 and BC7 are 16 bytes (BC1 colors plus BC4 alpha, or the
+// better quality all rounder). Against RGBA8 that is 8x and 4x less memory and upload bandwidth.
+//
+// Encoding is far too slow for load time, cook_texture does it offline (the linux build has -cook_texture for it)
+// and writes the whole mip chain into a .tex file. At runtime the blocks are uploaded as they are if the device
+// samples the format; otherwise decode_texture_level turns them back into RGBA8.
+//
+// The BC7 encoder only writes mode 6 blocks (one subset, RGBA endpoints, 16 steps); the decoder only reads those.
+enum Texture_Encoding {
+	TEXTURE_ENCODING_RGBA8,
+	TEXTURE_ENCODING_BC1,
+	TEXTURE_ENCODING_BC3,
+	TEXTURE_ENCODING_BC7,
+	TEXTURE_ENCODING_COUNT,
+};
+
+// a cooked texture as read from its file; levels points into file
+struct Cooked_Texture {
+	Texture_Encoding encoding;
+	uint32 width;
+	uint32 height;
+	uint32 level_count;
+	const uint8 *levels; // level after level, every level is get_encoded_level_size bytes
+	size_t levels_size;
+	File_Asset file;
+};
+
+// "rgba8", "bc1", "bc3" or "bc7"; false for anything else
+bool parse_texture_encoding(const char *name, Texture_Encoding *encoding);
+// blocks are stored row after row, partial blocks at the right and bottom edge are padded with the edge texels
+size_t get_encoded_level_size(Texture_Encoding encoding, uint32 width, uint32 height);
+
+void encode_texture_level(Texture_Encoding encoding, const uint8 *rgba, uint32 width, uint32 height, uint8 *blocks);
+// false if a block is something this decoder doesn't read, it is filled with magenta then
+bool decode_texture_level(Texture_Encoding encoding, const uint8 *blocks, uint32 width, uint32 height, uint8 *rgba);
+
+// loads any image stbi reads, builds its sRGB mip chain and writes it encoded into cooked_path
+bool cook_texture(const char *image_path, const char *cooked_path, Texture_Encoding encoding);
+// false if the file can't be read or isn't a cooked texture of this version
+bool read_cooked_texture(const char *cooked_path, Cooked_Texture *texture);
+void free_cooked_texture(Cooked_Texture *texture);
+
+#endif